@@ -22,7 +22,6 @@
 
 #include "Dialogs/Dialogs.h"
 #include "Components/GraphArea.h"
-#include "Utility/RateReducer.h"
 
 extern "C" {
 void canvas_setgraph(t_glist* x, int flag, int nogoprect);
@@ -189,6 +188,10 @@ Canvas::~Canvas()
 
 bool Canvas::updateFramebuffers(NVGcontext* nvg, Rectangle<int> invalidRegion, int maxUpdateTimeMs)
 {
+    // While zooming, the canvas is drawn from a scaled snapshot, so these only need to match the zoom level once it settles
+    if (isZooming)
+        return true;
+
     auto pixelScale = getRenderScale();
     auto zoom = getValue<float>(zoomScale);
 
@@ -312,6 +315,28 @@ bool Canvas::updateFramebuffers(NVGcontext* nvg, Rectangle<int> invalidRegion, i
     return true;
 }
 
+bool Canvas::needsFramebufferUpdate()
+{
+    if (isZooming)
+        return false;
+
+    // These sizes are calculated exactly like in updateFramebuffers(), otherwise rounding could make them differ forever
+    auto const pixelScale = getRenderScale();
+    auto const zoom = getValue<float>(zoomScale);
+    int const logicalIoletsSize = 16 * 4;
+    int const ioletBufferSize = logicalIoletsSize * pixelScale * zoom;
+    int const resizerLogicalSize = 9;
+    int const resizerBufferSize = resizerLogicalSize * pixelScale * zoom;
+    float const flagSize = 9;
+    int const flagArea = flagSize * pixelScale * zoom;
+
+    return ioletBuffer.needsUpdate(ioletBufferSize, ioletBufferSize)
+        || resizeHandleImage.needsUpdate(resizerBufferSize, resizerBufferSize)
+        || resizeGOPHandleImage.needsUpdate(resizerBufferSize, resizerBufferSize)
+        || objectFlag.needsUpdate(flagArea, flagArea)
+        || objectFlagSelected.needsUpdate(flagArea, flagArea);
+}
+
 // Callback from canvasViewport to perform actual rendering
 void Canvas::performRender(NVGcontext* nvg, Rectangle<int> invalidRegion)
 {
@@ -528,8 +553,10 @@ void Canvas::performRender(NVGcontext* nvg, Rectangle<int> invalidRegion)
 
             nvgStrokeColor(nvg, windowOutlineColour);
             nvgStrokeWidth(nvg, 0.5f / scale);
-            nvgFillPaint(nvg, shadowImage);
-            nvgFill(nvg);
+            if (editor->nvgSurface.getFrameGovernor().shouldDrawShadows()) {
+                nvgFillPaint(nvg, shadowImage);
+                nvgFill(nvg);
+            }
             nvgStroke(nvg);
         }
     }
@@ -620,16 +647,57 @@ void Canvas::updatePatchSnapshot()
     }
 }
 
+Rectangle<int> Canvas::getViewAreaForRenderLists() const
+{
+    // Graphs don't have a viewport, everything inside them is drawn
+    if (!viewport)
+        return {};
+
+    return (viewport->getViewArea() / getValue<float>(zoomScale)).expanded(Object::margin);
+}
+
+Array<Object*> const& Canvas::getObjectsInView()
+{
+    auto const viewArea = getViewAreaForRenderLists();
+    if (objectRenderListNeedsUpdate || viewArea != objectRenderListArea) {
+        objectRenderList.clearQuick();
+        for (auto* obj : objects) {
+            if (viewArea.isEmpty() || obj->getBounds().intersects(viewArea) || (obj->gui && obj->gui->labels))
+                objectRenderList.add(obj);
+        }
+
+        objectRenderListArea = viewArea;
+        objectRenderListNeedsUpdate = false;
+    }
+
+    return objectRenderList;
+}
+
+Array<Connection*> const& Canvas::getConnectionsInView()
+{
+    auto const viewArea = getViewAreaForRenderLists();
+    if (connectionRenderListNeedsUpdate || viewArea != connectionRenderListArea) {
+        connectionRenderList.clearQuick();
+        for (auto* connection : connections) {
+            if (viewArea.isEmpty() || connection->getBounds().intersects(viewArea))
+                connectionRenderList.add(connection);
+        }
+
+        connectionRenderListArea = viewArea;
+        connectionRenderListNeedsUpdate = false;
+    }
+
+    return connectionRenderList;
+}
+
 void Canvas::renderAllObjects(NVGcontext* nvg, Rectangle<int> area)
 {
-    for (auto* obj : objects) {
+    for (auto* obj : getObjectsInView()) {
         auto b = obj->getBounds();
-        {
+        if (b.intersects(area) && obj->isVisible()) {
             NVGScopedState scopedState(nvg);
             nvgTranslate(nvg, b.getX(), b.getY());
-            if (b.intersects(area) && obj->isVisible()) {
-                obj->render(nvg);
-            }
+            obj->render(nvg);
         }
         
         // Draw label in canvas coordinates
@@ -648,15 +716,16 @@ void Canvas::renderAllConnections(NVGcontext* nvg, Rectangle<int> area)
     Array<Connection*> connectionsToDrawSelected;
     Connection* hovered = nullptr;
 
-    for (auto* connection : connections) {
-        NVGScopedState scopedState(nvg);
+    for (auto* connection : getConnectionsInView()) {
         if (connection->intersectsRectangle(area) && connection->isVisible()) {
-            if (connection->isMouseHovering())
+            if (connection->isMouseHovering()) {
                 hovered = connection;
-            else if (!connection->isSelected())
+            } else if (!connection->isSelected()) {
+                NVGScopedState scopedState(nvg);
                 connection->render(nvg);
-            else
+            } else {
                 connectionsToDrawSelected.add(connection);
+            }
             if (showConnectionOrder) {
                 connectionsToDraw.add(connection);
             }
@@ -904,6 +973,33 @@ void Canvas::synchronise()
     triggerAsyncUpdate();
 }
 
+void Canvas::deferObjectInitialisation(ObjectBase* object)
+{
+    if (objectsAwaitingInitialisation.empty()) {
+        MessageManager::callAsync([_this = SafePointer(this)]() {
+            if (!_this)
+                return;
+
+            auto objectsToInitialise = std::move(_this->objectsAwaitingInitialisation);
+            _this->objectsAwaitingInitialisation.clear();
+
+            for (auto* object : objectsToInitialise) {
+                object->initialiseDeferred();
+            }
+        });
+    }
+
+    objectsAwaitingInitialisation.push_back(object);
+}
+
+void Canvas::cancelDeferredInitialisation(ObjectBase* object)
+{
+    // Objects are deleted in reverse order when a canvas closes, so search from the back
+    auto it = std::find(objectsAwaitingInitialisation.rbegin(), objectsAwaitingInitialisation.rend(), object);
+    if (it != objectsAwaitingInitialisation.rend())
+        objectsAwaitingInitialisation.erase(std::next(it).base());
+}
+
 void Canvas::synchroniseAllCanvases()
 {
     for (auto* editorWindow : pd->getEditors()){
@@ -1044,7 +1140,7 @@ void Canvas::performSynchronise()
             if (c.inlet != inlet || c.outlet != outlet) {
                 int idx = connections.indexOf(*it);
                 connections.removeObject(*it);
-                connections.insert(idx, new Connection(this, inlet, outlet, ptr));
+                connections.insert(idx, new Connection(this, inlet, outlet, ptr))->updateIoletOrder();
             } else {
                 c.popPathState();
             }
@@ -1213,7 +1309,7 @@ bool Canvas::hitTest(int x, int y)
 
 void Canvas::mouseDrag(MouseEvent const& e)
 {
-    if (canvasRateReducer.tooFast() || panningModifierDown())
+    if (panningModifierDown() || inputCoalescer.coalesceDrag(this, e))
         return;
 
     if (connectingWithDrag) {
@@ -1298,6 +1394,8 @@ bool Canvas::autoscroll(MouseEvent const& e)
 
 void Canvas::mouseUp(MouseEvent const& e)
 {
+    inputCoalescer.flush();
+
     setPanDragMode(false);
     setMouseCursor(MouseCursor::NormalCursor);
 
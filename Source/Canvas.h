@@ -16,7 +16,7 @@ using namespace juce::gl;
 #endif
 
 #include "ObjectGrid.h"          // move to impl
-#include "Utility/RateReducer.h" // move to impl
+#include "Utility/InputCoalescer.h"
 #include "Utility/ModifierKeyListener.h"
 #include "Components/CheckedTooltip.h"
 #include "Pd/MessageListener.h"
@@ -34,6 +34,7 @@ class SuggestionComponent;
 class GraphArea;
 class Iolet;
 class Object;
+class ObjectBase;
 class Connection;
 class PluginEditor;
 class PluginProcessor;
@@ -41,6 +42,21 @@ class ConnectionPathUpdater;
 class ConnectionBeingCreated;
 class TabComponent;
 
+// Layer for objects or connections, that flags the canvas' render list when one of its children is moved, resized, added or removed
+class RenderLayer : public Component {
+public:
+    explicit RenderLayer(bool& renderListNeedsUpdate)
+        : needsUpdate(renderListNeedsUpdate)
+    {
+    }
+
+    void childBoundsChanged(Component*) override { needsUpdate = true; }
+    void childrenChanged() override { needsUpdate = true; }
+
+private:
+    bool& needsUpdate;
+};
+
 struct ObjectDragState {
     bool wasDragDuplicated = false;
     bool didStartDragging = false;
@@ -88,6 +104,7 @@ public:
     void focusLost(FocusChangeType cause) override;
 
     bool updateFramebuffers(NVGcontext* nvg, Rectangle<int> invalidRegion, int maxUpdateTimeMs);
+    bool needsFramebufferUpdate(); // True if updateFramebuffers() has something to redraw
     void performRender(NVGcontext* nvg, Rectangle<int> invalidRegion);
 
     void resized() override;
@@ -95,6 +112,11 @@ public:
     void renderAllObjects(NVGcontext* nvg, Rectangle<int> area);
     void renderAllConnections(NVGcontext* nvg, Rectangle<int> area);
 
+    // Objects and connections that can be seen in the viewport, in drawing order
+    // These are kept between frames, so rendering a small part of a large patch doesn't have to go through everything on it
+    Array<Object*> const& getObjectsInView();
+    Array<Connection*> const& getConnectionsInView();
+
     int getOverlays() const;
     void updateOverlays();
 
@@ -109,6 +131,10 @@ public:
     void synchroniseAllCanvases();
     void synchroniseSplitCanvas();
     void synchronise();
+
+    // Objects that are created in the same message loop pass finish their setup together, in one async callback
+    void deferObjectInitialisation(ObjectBase* object);
+    void cancelDeferredInitialisation(ObjectBase* object);
     void performSynchronise();
     void handleAsyncUpdate() override;
 
@@ -206,6 +232,9 @@ public:
 
     // Needs to be allocated before object and connection so they can deselect themselves in the destructor
     SelectedItemSet<WeakReference<Component>> selectedComponents;
+    std::vector<ObjectBase*> objectsAwaitingInitialisation;
+    bool objectRenderListNeedsUpdate = true;
+    bool connectionRenderListNeedsUpdate = true;
     OwnedArray<Object> objects;
     OwnedArray<Connection> connections;
     OwnedArray<ConnectionBeingCreated> connectionsBeingCreated;
@@ -253,14 +282,14 @@ public:
     Point<int> pastedPadding;
 
     std::unique_ptr<ConnectionPathUpdater> pathUpdater;
-    RateReducer objectRateReducer = RateReducer(90);
+    InputCoalescer inputCoalescer { this };
 
     ObjectDragState dragState;
 
     inline static constexpr int infiniteCanvasSize = 128000;
 
-    Component objectLayer;
-    Component connectionLayer;
+    RenderLayer objectLayer { objectRenderListNeedsUpdate };
+    RenderLayer connectionLayer { connectionRenderListNeedsUpdate };
 
     NVGFramebuffer ioletBuffer;
     NVGImage resizeHandleImage;
@@ -273,6 +302,16 @@ public:
     Array<juce::WeakReference<NVGComponent>> drawables;
 
 private:
+    // Labels are children of the canvas, they can be seen when their object can't
+    void childBoundsChanged(Component*) override { objectRenderListNeedsUpdate = true; }
+    void childrenChanged() override { objectRenderListNeedsUpdate = true; }
+
+    Rectangle<int> getViewAreaForRenderLists() const;
+
+    Array<Object*> objectRenderList;
+    Array<Connection*> connectionRenderList;
+    Rectangle<int> objectRenderListArea, connectionRenderListArea;
+
     GlobalMouseListener globalMouseListener;
 
     bool dimensionsAreBeingEdited = false;
@@ -280,8 +319,6 @@ private:
     int lastMouseX, lastMouseY;
     LassoComponent<WeakReference<Component>> lasso;
 
-    RateReducer canvasRateReducer = RateReducer(90);
-
     // Properties that can be shown in the inspector by right-clicking on canvas
     ObjectParameters parameters;
 
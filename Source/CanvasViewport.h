@@ -281,6 +281,15 @@ class CanvasViewport : public Viewport
         int inset;
     };
 
+    // Moving the canvas makes JUCE repaint the whole viewport
+    // We block that here, and handle it in visibleAreaChanged, where we can scroll the image that's already rendered
+    struct ScrollRepaintFilter : public CachedComponentImage {
+        void paint(Graphics& g) override {};
+        bool invalidate(Rectangle<int> const& rect) override { return false; }
+        bool invalidateAll() override { return false; }
+        void releaseResources() override {};
+    };
+
 public:
     CanvasViewport(PluginEditor* parent, Canvas* cnv)
         : NVGComponent(this)
@@ -306,6 +315,8 @@ public:
 
     ~CanvasViewport()
     {
+        if (scaleChanged)
+            editor->nvgSurface.endZoom();
     }
 
     void render(NVGcontext* nvg) override
@@ -427,6 +438,13 @@ public:
         adjustScrollbarBounds();
     }
 
+    void viewedComponentChanged(Component* newComponent) override
+    {
+        if (auto* contentHolder = newComponent ? newComponent->getParentComponent() : nullptr) {
+            contentHolder->setCachedComponentImage(new ScrollRepaintFilter());
+        }
+    }
+
     void visibleAreaChanged(Rectangle<int> const& r) override
     {
         if(scaleChanged) {
@@ -435,7 +453,39 @@ public:
         }
         onScroll();
         adjustScrollbarBounds();
-        editor->nvgSurface.invalidateAll();
+
+        auto& surface = editor->nvgSurface;
+        auto viewportBounds = surface.getLocalArea(this, getLocalBounds());
+        auto canvasOrigin = surface.getLocalPoint(cnv, Point<float>());
+        auto canvasScale = std::sqrt(std::abs(cnv->getTransform().getDeterminant()));
+
+        // If only the canvas position changed, we can move the rendered image instead of drawing it again
+        // While zooming, we scale the last rendered image until the gesture ends
+        if ((scaleChanged || approximatelyEqual(canvasScale, lastCanvasScale)) && viewportBounds == lastViewportBounds && !editor->isInPluginMode()) {
+            // Leave out the edges and scrollbars, since they're drawn on top of the canvas
+            auto scrollingArea = getLocalBounds().reduced(3);
+            if (vbar.isVisible())
+                scrollingArea.setRight(vbar.getX() - 1);
+            if (hbar.isVisible())
+                scrollingArea.setBottom(hbar.getY() - 1);
+
+            scrollingArea = surface.getLocalArea(this, scrollingArea);
+
+            RectangleList<int> overlays(viewportBounds);
+            overlays.subtract(scrollingArea);
+            overlays.add(editor->getCanvasOverlayBounds());
+
+            if (scaleChanged)
+                surface.zoomArea(scrollingArea, lastCanvasOrigin, lastCanvasScale, canvasOrigin, canvasScale, overlays);
+            else
+                surface.scrollArea(scrollingArea, canvasOrigin - lastCanvasOrigin, overlays);
+        } else {
+            surface.invalidateAll();
+        }
+
+        lastViewportBounds = viewportBounds;
+        lastCanvasOrigin = canvasOrigin;
+        lastCanvasScale = canvasScale;
     }
 
     void timerCallback() override
@@ -450,6 +500,7 @@ public:
         }
         
         scaleChanged = false;
+        editor->nvgSurface.endZoom();
         editor->nvgSurface.invalidateAll();
     }
 
@@ -502,6 +553,9 @@ private:
     PluginEditor* editor;
     Canvas* cnv;
     Rectangle<int> previousBounds;
+    Rectangle<int> lastViewportBounds;
+    Point<float> lastCanvasOrigin;
+    float lastCanvasScale = 1.0f;
     MousePanner panner = MousePanner(this);
     ViewportScrollBar vbar = ViewportScrollBar(true, this);
     ViewportScrollBar hbar = ViewportScrollBar(false, this);
@@ -44,6 +44,9 @@ Connection::Connection(Canvas* parent, Iolet* s, Iolet* e, t_outconnect* oc)
         return;
     }
 
+    outlet->connections.add(this);
+    inlet->connections.add(this);
+
     cableType = DataCable;
 
     if (outlet && outlet->isSignal) {
@@ -97,6 +100,7 @@ Connection::~Connection()
     cnv->selectedComponents.removeChangeListener(this);
 
     if (outlet) {
+        outlet->connections.removeFirstMatchingValue(this);
         outlet->repaint();
         outlet->removeComponentListener(this);
     }
@@ -105,6 +109,7 @@ Connection::~Connection()
     }
 
     if (inlet) {
+        inlet->connections.removeFirstMatchingValue(this);
         inlet->repaint();
         inlet->removeComponentListener(this);
     }
@@ -199,17 +204,31 @@ void Connection::render(NVGcontext* nvg)
         return;
     }
 
-    float dashSize = isSignalCable ? (numSignalChannels <= 1) ? 2.5f : 1.5f : 0.0f;
-    auto useGradientLook = PlugDataLook::getUseGradientConnectionLook() && !(isSelected() || isHovering);
-    auto showActivity = cableType == DataCable && cnv->shouldShowConnectionActivity();
-    nvgStrokePaint(nvg, nvgDoubleStroke(nvg, connectionColour, shadowColour, dashColor, dashSize, useGradientLook, showActivity, offset));
+    auto const& governor = cnv->editor->nvgSurface.getFrameGovernor();
+
+    // When rendering can't keep up, we leave out the outline and signal dashes
+    if (governor.shouldDrawShadows()) {
+        float dashSize = isSignalCable ? (numSignalChannels <= 1) ? 2.5f : 1.5f : 0.0f;
+        auto useGradientLook = PlugDataLook::getUseGradientConnectionLook() && !(isSelected() || isHovering);
+        auto showActivity = cableType == DataCable && cnv->shouldShowConnectionActivity();
+        nvgStrokePaint(nvg, nvgDoubleStroke(nvg, connectionColour, shadowColour, dashColor, dashSize, useGradientLook, showActivity, offset));
+    } else {
+        nvgStrokeColor(nvg, connectionColour);
+    }
     nvgStrokeWidth(nvg, cableThickness);
 
     if (!cachedIsValid)
         nvgDeletePath(nvg, cacheId);
-    
-    bool cacheHit = nvgStrokeCachedPath(nvg, cacheId);
-    if (!cacheHit) {
+
+    if (governor.shouldDrawStraightConnections() && !segmented) {
+        auto start = getStartPoint() - getPosition().toFloat();
+        auto end = getEndPoint() - getPosition().toFloat();
+
+        nvgBeginPath(nvg);
+        nvgMoveTo(nvg, start.x, start.y);
+        nvgLineTo(nvg, end.x, end.y);
+        nvgStroke(nvg);
+    } else if (!nvgStrokeCachedPath(nvg, cacheId)) {
         auto pathFromOrigin = getPath();
         pathFromOrigin.applyTransform(AffineTransform::translation(-getX(), -getY()));
 
@@ -1002,26 +1021,35 @@ Path Connection::getNonSegmentedPath(Point<float> start, Point<float> end)
 
 int Connection::getNumberOfConnections()
 {
-    int count = 0;
-    for (auto* connection : cnv->connections) {
-        if (outlet == connection->outlet) {
-            count++;
+    return outlet ? outlet->getNumConnections() : 0;
+}
+
+void Connection::updateIoletOrder()
+{
+    auto const canvasIndex = cnv->connections.indexOf(this);
+
+    for (auto* iolet : { inlet.get(), outlet.get() }) {
+        if (!iolet)
+            continue;
+
+        iolet->connections.removeFirstMatchingValue(this);
+
+        int position = 0;
+        for (auto* other : iolet->connections) {
+            if (cnv->connections.indexOf(other) < canvasIndex)
+                position++;
         }
+        iolet->connections.insert(position, this);
     }
-    return count;
 }
 
 int Connection::getMultiConnectNumber()
 {
-    int count = 0;
-    for (auto* connection : cnv->connections) {
-        if (outlet == connection->outlet) {
-            count++;
-            if (this == connection)
-                return count;
-        }
-    }
-    return -1;
+    if (!outlet)
+        return -1;
+
+    auto const idx = outlet->connections.indexOf(this);
+    return idx >= 0 ? idx + 1 : -1;
 }
 
 int Connection::getSignalData(t_float* output, int maxChannels)
@@ -14,7 +14,7 @@
 #include "Iolet.h"       // Move to impl
 #include "Pd/Instance.h" // Move to impl
 #include "Pd/MessageListener.h"
-#include "Utility/RateReducer.h"
+#include "Utility/InputCoalescer.h"
 #include "Utility/ModifierKeyListener.h"
 #include "NVGSurface.h"
 #include "LookAndFeel.h"
@@ -42,6 +42,10 @@ public:
     Connection(Canvas* parent, Iolet* start, Iolet* end, t_outconnect* oc);
     ~Connection() override;
 
+    // A new connection goes to the end of its iolets' lists, this moves it to the same place it has in the canvas' list
+    // Needed when it's inserted into the canvas anywhere else than at the end, otherwise its multi-connect number changes
+    void updateIoletOrder();
+
     static Path getNonSegmentedPath(Point<float> start, Point<float> end);
 
     bool isSegmented() const;
@@ -223,18 +227,17 @@ public:
 
     void mouseDrag(MouseEvent const& e) override
     {
-        if (rateReducer.tooFast())
-            return;
-        
-        updatePosition(e.getEventRelativeTo(cnv).position);
+        // Only the latest position matters, so it's drawn once per frame
+        inputCoalescer.coalesce(this, [this, position = e.getEventRelativeTo(cnv).position]() {
+            updatePosition(position);
+        });
     }
 
     void mouseMove(MouseEvent const& e) override
     {
-        if (rateReducer.tooFast())
-            return;
-        
-        updatePosition(e.getEventRelativeTo(cnv).position);
+        inputCoalescer.coalesce(this, [this, position = e.getEventRelativeTo(cnv).position]() {
+            updatePosition(position);
+        });
     }
         
     void updatePosition(Point<float> cursorPoint)
@@ -308,7 +311,7 @@ public:
         return iolet;
     }
 
-    RateReducer rateReducer = RateReducer(90);
+    InputCoalescer inputCoalescer { this };
 };
 
 // Helper class to group connection path changes together into undoable/redoable actions
@@ -129,6 +129,12 @@ public:
         patchDownwardsOnly = settingsFile->getPropertyAsValue("patch_downwards_only");
         otherProperties.add(new PropertiesPanel::BoolComponent("Patch downwards only", patchDownwardsOnly, { "No", "Yes" }));
 
+        patchCache = settingsFile->getPropertyAsValue("patch_cache");
+        otherProperties.add(new PropertiesPanel::BoolComponent("Cache patches for faster loading", patchCache, { "No", "Yes" }));
+
+        audioLockGuard = settingsFile->getPropertyAsValue("audio_lock_guard");
+        otherProperties.add(new PropertiesPanel::BoolComponent("Never let audio wait for the editor", audioLockGuard, { "No", "Yes" }));
+
         propertiesPanel.addSection("Interface", interfaceProperties);
         propertiesPanel.addSection("Autosave", autosaveProperties);
         propertiesPanel.addSection("Other", otherProperties);
@@ -191,6 +197,8 @@ public:
     Value autosaveEnabled;
 
     Value patchDownwardsOnly;
+    Value patchCache;
+    Value audioLockGuard;
 
     PropertiesPanel propertiesPanel;
 
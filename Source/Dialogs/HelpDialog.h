@@ -6,12 +6,13 @@
 
 #include "Components/MarkupDisplay.h"
 #include "Components/BouncingViewport.h"
+#include "Utility/InputCoalescer.h"
 
 class HelpDialog : public TopLevelWindow
     , public MarkupDisplay::FileSource {
     std::unique_ptr<Button> closeButton;
     ComponentDragger windowDragger;
-    std::unique_ptr<MouseRateReducedComponent<ResizableBorderComponent>> resizer;
+    std::unique_ptr<MouseCoalescedComponent<ResizableBorderComponent>> resizer;
 
     static inline File const manualPath = ProjectInfo::appDataDir.getChildFile("Extra").getChildFile("Manual");
 
@@ -112,7 +113,7 @@ public:
         constrainer.setSizeLimits(500, 300, 1400, 1000);
         constrainer.setFixedAspectRatio(0.0f);
 
-        resizer = std::make_unique<MouseRateReducedComponent<ResizableBorderComponent>>(this, &constrainer);
+        resizer = std::make_unique<MouseCoalescedComponent<ResizableBorderComponent>>(this, &constrainer);
         // resizer->setAllowHostManagedResize(false);
         resizer->setAlwaysOnTop(true);
         addAndMakeVisible(resizer.get());
@@ -49,7 +49,7 @@ public:
     {
         repaint();
 
-        processor->enableInternalSynth = getValue<bool>(toggleStateValue);
+        processor->setInternalSynthEnabled(getValue<bool>(toggleStateValue));
         processor->settingsFile->setProperty("internal_synth", static_cast<int>(processor->enableInternalSynth));
     }
 
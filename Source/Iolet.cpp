@@ -219,6 +219,12 @@ void Iolet::mouseUp(MouseEvent const& e)
     cnv->connectionCancelled = false;
 }
 
+String Iolet::getTooltip()
+{
+    object->resolveTooltips();
+    return SettableTooltipClient::getTooltip();
+}
+
 void Iolet::mouseEnter(MouseEvent const& e)
 {
     isTargeted = true;
@@ -333,16 +339,14 @@ void Iolet::createConnection()
     }
 }
 
-Array<Connection*> Iolet::getConnections()
+Array<Connection*> const& Iolet::getConnections() const
 {
-    Array<Connection*> result;
-    for (auto* c : object->cnv->connections) {
-        if (c->inlet == this || c->outlet == this) {
-            result.add(c);
-        }
-    }
+    return connections;
+}
 
-    return result;
+int Iolet::getNumConnections() const
+{
+    return connections.size();
 }
 
 Iolet* Iolet::findNearestIolet(Canvas* cnv, Point<int> position, bool inlet, Object* objectToExclude)
@@ -23,6 +23,8 @@ public:
 
     void mouseEnter(MouseEvent const& e) override;
     void mouseExit(MouseEvent const& e) override;
+
+    String getTooltip() override;
         
     Iolet* getNextIolet();
 
@@ -38,7 +40,10 @@ public:
 
     void setHidden(bool hidden);
 
-    Array<Connection*> getConnections();
+    // Connections attached to this iolet, without having to search all connections on the canvas
+    // Don't hold on to this while creating or deleting connections
+    Array<Connection*> const& getConnections() const;
+    int getNumConnections() const;
 
     Rectangle<int> getCanvasBounds();
 
@@ -61,6 +66,10 @@ private:
     Value commandLocked;
     Value presentationMode;
 
+    // Kept up to date by the constructor and destructor of Connection
+    Array<Connection*> connections;
+    friend class Connection;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Iolet)
     JUCE_DECLARE_WEAK_REFERENCEABLE(Iolet)
 };
@@ -90,6 +90,12 @@ NVGSurface::NVGSurface(PluginEditor* e)
     frameTimer = std::make_unique<FrameTimer>();
 #endif
 
+    // Quality changes are rare, so we can check the setting each time
+    frameGovernor.onDecision = [](FrameGovernor::Decision const& decision) {
+        if (SettingsFile::getInstance()->getProperty<bool>("frame_governor_log"))
+            ProjectInfo::appDataDir.getChildFile("frame-governor.csv").appendText(FrameGovernor::toString(decision) + "\n");
+    };
+
     setInterceptsMouseClicks(false, false);
     setWantsKeyboardFocus(false);
 
@@ -158,6 +164,7 @@ void NVGSurface::detachContext()
             nvgDeleteFramebuffer(mainFBO);
             mainFBO = nullptr;
         }
+        deleteZoomFramebuffers();
         if (nvg) {
             nvgDeleteContext(nvg);
             nvg = nullptr;
@@ -186,6 +193,7 @@ void NVGSurface::updateBufferSize()
             nvgDeleteFramebuffer(invalidFBO);
         if (mainFBO)
             nvgDeleteFramebuffer(mainFBO);
+        deleteZoomFramebuffers();
         mainFBO = nvgCreateFramebuffer(nvg, scaledWidth, scaledHeight, NVG_IMAGE_PREMULTIPLIED);
         invalidFBO = nvgCreateFramebuffer(nvg, scaledWidth, scaledHeight, NVG_IMAGE_PREMULTIPLIED);
         fbWidth = scaledWidth;
@@ -287,9 +295,287 @@ void NVGSurface::invalidateArea(Rectangle<int> area)
     invalidArea = invalidArea.getUnion(area);
 }
 
+void NVGSurface::scrollArea(Rectangle<int> area, Point<float> delta, RectangleList<int> const& overlays)
+{
+    // We only scroll one area per frame, if another canvas scrolls at the same time we render it again instead
+    if (!scrollingArea.isEmpty() && scrollingArea != area) {
+        invalidateArea(area);
+    } else {
+        scrollingArea = area;
+        scrollDelta += delta;
+    }
+
+    exposedAreas.add(overlays);
+}
+
+void NVGSurface::renderToMainFramebuffer(Rectangle<int> area, float pixelScale)
+{
+    auto desktopScale = Desktop::getInstance().getGlobalScaleFactor();
+    auto devicePixelScale = pixelScale / desktopScale;
+
+#if NANOVG_METAL_IMPLEMENTATION
+    auto viewWidth = 0; // Not relevant for Metal
+    auto viewHeight = 0;
+#else
+    auto viewWidth = getWidth() * pixelScale;
+    auto viewHeight = getHeight() * pixelScale;
+#endif
+
+    // First, draw only the invalidated region to a separate framebuffer
+    // I've found that nvgScissor doesn't always clip everything, meaning that there will be graphical glitches if we don't do this
+    nvgBindFramebuffer(invalidFBO);
+    nvgViewport(0, 0, viewWidth, viewHeight);
+    nvgClear(nvg);
+
+    nvgBeginFrame(nvg, getWidth() * desktopScale, getHeight() * desktopScale, devicePixelScale);
+    nvgShapeAntiAlias(nvg, frameGovernor.shouldAntialias());
+    nvgScale(nvg, desktopScale, desktopScale);
+    nvgScissor(nvg, area.getX(), area.getY(), area.getWidth(), area.getHeight());
+    editor->renderArea(nvg, area);
+    nvgEndFrame(nvg);
+
+    blitFramebuffer(invalidFBO, mainFBO, area.toFloat(), { 0.0f, 0.0f }, pixelScale);
+}
+
+void NVGSurface::beginFramebufferFrame(NVGframebuffer* target, float pixelScale)
+{
+    auto desktopScale = Desktop::getInstance().getGlobalScaleFactor();
+    auto devicePixelScale = pixelScale / desktopScale;
+
+    nvgBindFramebuffer(target);
+#if NANOVG_GL_IMPLEMENTATION
+    nvgViewport(0, 0, getWidth() * pixelScale, getHeight() * pixelScale);
+    nvgBeginFrame(nvg, getWidth(), getHeight(), devicePixelScale);
+#else
+    nvgBeginFrame(nvg, getWidth() * desktopScale, getHeight() * desktopScale, devicePixelScale);
+    nvgScale(nvg, desktopScale, desktopScale);
+#endif
+}
+
+void NVGSurface::blitFramebuffer(NVGframebuffer* source, NVGframebuffer* target, Rectangle<float> area, Point<float> offset, float pixelScale)
+{
+    beginFramebufferFrame(target, pixelScale);
+
+    nvgBeginPath(nvg);
+    nvgScissor(nvg, area.getX(), area.getY(), area.getWidth(), area.getHeight());
+
+    nvgFillPaint(nvg, nvgImagePattern(nvg, offset.x, offset.y, getWidth(), getHeight(), 0, source->image, 1));
+    nvgFillRect(nvg, area.getX(), area.getY(), area.getWidth(), area.getHeight());
+
+#if ENABLE_FB_DEBUGGING
+    static Random rng;
+    nvgFillColor(nvg, nvgRGBA(rng.nextInt(255), rng.nextInt(255), rng.nextInt(255), 0x50));
+    nvgFillRect(nvg, 0, 0, getWidth(), getHeight());
+#endif
+
+    nvgEndFrame(nvg);
+    nvgBindFramebuffer(nullptr);
+}
+
+void NVGSurface::zoomArea(Rectangle<int> area, Point<float> snapshotOrigin, float snapshotScale, Point<float> origin, float scale, RectangleList<int> const& overlays)
+{
+    if (zoomState.isActive && zoomState.area != area) {
+        invalidateArea(area);
+        return;
+    }
+
+    if (!zoomState.isActive) {
+        zoomState.area = area;
+        zoomState.snapshotOrigin = snapshotOrigin;
+        zoomState.snapshotScale = snapshotScale;
+        zoomState.isActive = true;
+        zoomState.needsCapture = true;
+
+        // A scroll that we haven't rendered yet isn't in the snapshot either
+        if (scrollingArea == area) {
+            zoomState.snapshotOrigin -= scrollDelta;
+            scrollingArea = Rectangle<int>();
+            scrollDelta = Point<float>();
+        }
+    }
+
+    zoomState.origin = origin;
+    zoomState.scale = scale;
+    zoomState.needsRender = true;
+    exposedAreas.add(overlays);
+}
+
+void NVGSurface::endZoom()
+{
+    if (zoomState.isActive) {
+        invalidateArea(zoomState.area);
+        zoomState = ZoomState();
+    }
+}
+
+void NVGSurface::deleteZoomFramebuffers()
+{
+    for (auto*& zoomFBO : zoomFBOs) {
+        if (zoomFBO) {
+            nvgDeleteFramebuffer(zoomFBO);
+            zoomFBO = nullptr;
+        }
+    }
+}
+
+void NVGSurface::captureZoomSnapshot(float pixelScale)
+{
+    zoomState.needsCapture = false;
+
+    for (int level = 0; level < numZoomLevels; level++) {
+        if (!zoomFBOs[level]) {
+            zoomFBOs[level] = nvgCreateFramebuffer(nvg, std::max(1, fbWidth >> level), std::max(1, fbHeight >> level), NVG_IMAGE_PREMULTIPLIED);
+        }
+
+        // Halving the previous level averages every 2x2 block of pixels, so zooming out far doesn't skip over details and flicker
+        auto* source = level == 0 ? mainFBO : zoomFBOs[level - 1];
+        blitFramebuffer(source, zoomFBOs[level], zoomState.area.toFloat(), { 0.0f, 0.0f }, pixelScale / static_cast<float>(1 << level));
+    }
+}
+
+void NVGSurface::renderZoomFrame(float pixelScale)
+{
+    auto const area = zoomState.area.toFloat();
+    auto const scale = zoomState.scale / zoomState.snapshotScale;
+
+    // Use the smallest level that still has at least one pixel for every pixel on screen
+    int level = 0;
+    while (level < numZoomLevels - 1 && scale * static_cast<float>(1 << (level + 1)) <= 1.0f)
+        level++;
+
+    beginFramebufferFrame(mainFBO, pixelScale);
+    nvgScissor(nvg, area.getX(), area.getY(), area.getWidth(), area.getHeight());
+
+    // When zooming out, this becomes visible around the snapshot
+    auto backgroundColour = editor->pd->lnf->findColour(PlugDataColour::canvasBackgroundColourId);
+    nvgFillColor(nvg, nvgRGB(backgroundColour.getRed(), backgroundColour.getGreen(), backgroundColour.getBlue()));
+    nvgFillRect(nvg, area.getX(), area.getY(), area.getWidth(), area.getHeight());
+
+    auto const offset = zoomState.origin - zoomState.snapshotOrigin * scale;
+    nvgTranslate(nvg, offset.x, offset.y);
+    nvgScale(nvg, scale, scale);
+
+    nvgBeginPath(nvg);
+    nvgFillPaint(nvg, nvgImagePattern(nvg, 0, 0, getWidth(), getHeight(), 0, zoomFBOs[level]->image, 1));
+    nvgFillRect(nvg, area.getX(), area.getY(), area.getWidth(), area.getHeight());
+
+    nvgEndFrame(nvg);
+    nvgBindFramebuffer(nullptr);
+}
+
+void NVGSurface::startFrameTrace()
+{
+    frameTrace.clear();
+    isTracingFrames = true;
+}
+
+std::vector<NVGSurface::FrameTiming> NVGSurface::stopFrameTrace()
+{
+    isTracingFrames = false;
+    return std::move(frameTrace);
+}
+
+void NVGSurface::scrollMainFramebuffer(float pixelScale)
+{
+    auto const area = scrollingArea;
+    auto const delta = scrollDelta;
+    scrollingArea = Rectangle<int>();
+    scrollDelta = Point<float>();
+
+    // Anything that was invalidated inside the scrolling area has moved along with the content
+    auto movedInvalidArea = invalidArea.getIntersection(area).toFloat().translated(delta.x, delta.y).getSmallestIntegerContainer();
+    invalidArea = invalidArea.getUnion(movedInvalidArea.getIntersection(area));
+
+    // Only the part that remains visible can be reused, snapped inwards to whole device pixels
+    auto reused = area.toFloat().getIntersection(area.toFloat().translated(delta.x, delta.y)) * pixelScale;
+    reused = Rectangle<float>::leftTopRightBottom(std::ceil(reused.getX()), std::ceil(reused.getY()), std::floor(reused.getRight()), std::floor(reused.getBottom())) / pixelScale;
+
+    // Moving the image by a fraction of a pixel would make it blurry, so in that case we render everything again
+    auto const pixelDelta = delta * pixelScale;
+    auto const isWholePixelMove = std::abs(pixelDelta.x - std::round(pixelDelta.x)) < 0.01f && std::abs(pixelDelta.y - std::round(pixelDelta.y)) < 0.01f;
+
+    if (!isWholePixelMove || reused.isEmpty() || invalidArea.contains(area)) {
+        invalidArea = invalidArea.getUnion(area);
+        return;
+    }
+
+    // We can't read from and draw to the same framebuffer, so we move the image through the invalid framebuffer
+    blitFramebuffer(mainFBO, invalidFBO, reused, delta, pixelScale);
+    blitFramebuffer(invalidFBO, mainFBO, reused, { 0.0f, 0.0f }, pixelScale);
+
+    RectangleList<float> exposed(area.toFloat());
+    exposed.subtract(reused);
+    for (auto const& rect : exposed) {
+        exposedAreas.add(rect.getSmallestIntegerContainer());
+    }
+}
+
+bool NVGSurface::isSuspended() const
+{
+    auto* peer = getPeer();
+    if (!peer || !editor->isShowing()) // Also false when minimised
+        return true;
+
+#if JUCE_MAC
+    return OSUtils::isWindowOccluded(peer->getNativeHandle());
+#else
+    return false;
+#endif
+}
+
+bool NVGSurface::hasPendingWork() const
+{
+    if (!nvg || needsBufferSwap || !invalidArea.isEmpty() || !exposedAreas.isEmpty() || !scrollingArea.isEmpty() || zoomState.needsCapture || zoomState.needsRender)
+        return true;
+
+    // Moved to a screen with a different scale, or resized without anything repainting
+    if (auto* peer = getPeer(); peer && peer->getPlatformScaleFactor() * Desktop::getInstance().getGlobalScaleFactor() != lastPeerScale)
+        return true;
+
+    // Framebuffers are updated at the end of a frame, which doesn't happen if there wasn't enough time left or the frame was skipped
+    for (auto* cnv : editor->getTabComponent().getVisibleCanvases()) {
+        if (cnv->needsFramebufferUpdate())
+            return true;
+    }
+
+    return fbWidth != static_cast<int>(getWidth() * lastRenderScale) || fbHeight != static_cast<int>(getHeight() * lastRenderScale);
+}
+
+// Everything here runs on the message thread, including the GL calls: drawing is not recorded for a separate render thread
+// Objects create and update their NVGImages, NVGFramebuffers and text caches while they render, and a NanoVG context can only be used from one thread
+// To keep large canvases responsive, each canvas only goes through the objects and connections in view (see Canvas::getObjectsInView())
 void NVGSurface::render()
 {
+    if (isSuspended()) {
+        // Keep handling pd messages now and then, so the GUI is up-to-date when we come back, and the queue can't pile up
+        auto const now = Time::getMillisecondCounter();
+        if (now - lastSuspendedFlush >= 100) {
+            editor->pd->flushMessageQueue();
+            lastSuspendedFlush = now;
+        }
+        wasSuspended = true;
+        return;
+    }
+
+    // Whatever was invalidated while we were suspended wasn't tracked precisely, so render everything once
+    if (wasSuspended) {
+        wasSuspended = false;
+        invalidateAll();
+    }
+
+    // Nothing to draw and no messages for the GUI, so skip this frame before we do any GL work
+    if (!hasPendingWork() && !editor->pd->messageDispatcher->hasPendingMessages()) {
+        // Skipped frames don't tell the governor anything about load, so it recovers quality over time instead
+        if (frameGovernor.addIdleFrame())
+            invalidateAll();
+        return;
+    }
+
+    // Message handling counts towards the frame time as well, since it's what makes the GUI slow to respond
+    auto startTimeHiRes = Time::getMillisecondCounterHiRes();
+
     // Flush message queue before rendering, to make sure all GUIs are up-to-date
+    editor->pd->messageDispatcher->setMinimumUpdateInterval(frameGovernor.getMinimumUpdateInterval());
     editor->pd->flushMessageQueue();
     
 #if ENABLE_FPS_COUNT
@@ -318,6 +604,9 @@ void NVGSurface::render()
         detachContext();
         return; // Render on next frame
     }
+
+    if (auto* peer = getPeer())
+        lastPeerScale = peer->getPlatformScaleFactor() * Desktop::getInstance().getGlobalScaleFactor();
     
 #if NANOVG_METAL_IMPLEMENTATION
     if(pixelScale == 0) // This happens sometimes when an AUv3 plugin is hidden behind the parameter control view
@@ -332,47 +621,52 @@ void NVGSurface::render()
 #endif
     
     updateBufferSize();
-    
-    if (!invalidArea.isEmpty()) {
-        // First, draw only the invalidated region to a separate framebuffer
-        // I've found that nvgScissor doesn't always clip everything, meaning that there will be graphical glitches if we don't do this
-        nvgBindFramebuffer(invalidFBO);
-        nvgViewport(0, 0, viewWidth, viewHeight);
-        nvgClear(nvg);
 
-        nvgBeginFrame(nvg, getWidth() * desktopScale, getHeight() * desktopScale, devicePixelScale);
-        nvgScale(nvg, desktopScale, desktopScale);
-        nvgScissor(nvg, invalidArea.getX(), invalidArea.getY(), invalidArea.getWidth(), invalidArea.getHeight());
-        editor->renderArea(nvg, invalidArea);
-        nvgEndFrame(nvg);
+    // Capture the last full render before anything else draws over it
+    if (zoomState.needsCapture) {
+        captureZoomSnapshot(pixelScale);
+    }
 
-        nvgBindFramebuffer(mainFBO);
-#if NANOVG_GL_IMPLEMENTATION
-        nvgViewport(0, 0, viewWidth, viewHeight);
-        nvgBeginFrame(nvg, getWidth(), getHeight(), devicePixelScale);
-#else
-        nvgBeginFrame(nvg, getWidth() * desktopScale, getHeight() * desktopScale, devicePixelScale);
-        nvgScale(nvg, desktopScale, desktopScale);
-#endif
-        nvgBeginPath(nvg);
-        nvgScissor(nvg, invalidArea.getX(), invalidArea.getY(), invalidArea.getWidth(), invalidArea.getHeight());
+    if (!scrollingArea.isEmpty()) {
+        scrollMainFramebuffer(pixelScale);
+    }
 
-        nvgFillPaint(nvg, nvgImagePattern(nvg, 0, 0, getWidth(), getHeight(), 0, invalidFBO->image, 1));
-        nvgFillRect(nvg, invalidArea.getX(), invalidArea.getY(), invalidArea.getWidth(), invalidArea.getHeight());
+    auto const isInterimZoomFrame = zoomState.isActive && zoomState.needsRender;
+    if (isInterimZoomFrame) {
+        renderZoomFrame(pixelScale);
+        zoomState.needsRender = false;
+        needsBufferSwap = true;
+    }
 
-#if ENABLE_FB_DEBUGGING
-        static Random rng;
-        nvgFillColor(nvg, nvgRGBA(rng.nextInt(255), rng.nextInt(255), rng.nextInt(255), 0x50));
-        nvgFillRect(nvg, 0, 0, getWidth(), getHeight());
-#endif
+    if (zoomState.isActive) {
+        // Everything inside the zoomed area will be rendered when the zoom gesture ends
+        RectangleList<int> outsideZoomArea(invalidArea);
+        outsideZoomArea.subtract(zoomState.area);
+        exposedAreas.add(outsideZoomArea);
+        exposedAreas.subtract(zoomState.area);
+        invalidArea = Rectangle<int>(0, 0, 0, 0);
+    }
 
-        nvgEndFrame(nvg);
+    if (!exposedAreas.isEmpty()) {
+        // Render the strips that scrolling exposed separately, their union would often cover the whole area again
+        exposedAreas.consolidate();
+        for (auto const& area : exposedAreas) {
+            if (!invalidArea.contains(area))
+                renderToMainFramebuffer(area, pixelScale);
+        }
+
+        needsBufferSwap = true;
+        exposedAreas.clear();
+    }
+
+    if (!invalidArea.isEmpty()) {
+        renderToMainFramebuffer(invalidArea, pixelScale);
 
-        nvgBindFramebuffer(nullptr);
         needsBufferSwap = true;
         invalidArea = Rectangle<int>(0, 0, 0, 0);
     }
 
+    auto const renderedFrame = needsBufferSwap;
     if (needsBufferSwap) {
 #if NANOVG_GL_IMPLEMENTATION
         nvgViewport(0, 0, viewWidth, viewHeight);
@@ -411,6 +705,17 @@ void NVGSurface::render()
     }
 
     auto elapsed = Time::getMillisecondCounter() - startTime;
+
+    if (renderedFrame) {
+        auto const frameTime = Time::getMillisecondCounterHiRes() - startTimeHiRes;
+        if (isTracingFrames)
+            frameTrace.push_back({ frameTime, isInterimZoomFrame });
+
+        // Render everything again when the quality changes, so the whole view looks consistent
+        if (frameGovernor.addFrameTime(frameTime))
+            invalidateAll();
+    }
+
     // We update frambuffers after we call swapBuffers to make sure the frame is on time
     if (elapsed < 14) {
         for (auto* cnv : editor->getTabComponent().getVisibleCanvases()) {
@@ -12,6 +12,7 @@ using namespace juce::gl;
 
 #include "Utility/Config.h"
 #include "Utility/SettingsFile.h"
+#include "Utility/FrameGovernor.h"
 
 #include <nanovg.h>
 #ifdef NANOVG_GL_IMPLEMENTATION
@@ -97,6 +98,30 @@ public:
     void invalidateArea(Rectangle<int> area);
     void invalidateAll();
 
+    // Moves what was already rendered inside area by delta, so only the newly exposed parts need to be rendered
+    // Overlays are parts of the surface that don't move along with the content, they will be rendered again
+    void scrollArea(Rectangle<int> area, Point<float> delta, RectangleList<int> const& overlays);
+
+    // Shows what was last rendered inside area, scaled and moved along with the canvas, instead of rendering the canvas again at every step of a zoom gesture
+    // The first call captures the last full render, in which the canvas was at snapshotOrigin and snapshotScale
+    void zoomArea(Rectangle<int> area, Point<float> snapshotOrigin, float snapshotScale, Point<float> origin, float scale, RectangleList<int> const& overlays);
+    // Renders the zoomed area at full quality again, call this when the zoom gesture has settled
+    void endZoom();
+
+    // Frame-time trace, for checking rendering performance
+    struct FrameTiming {
+        double renderTime; // Milliseconds spent rendering the frame, not including framebuffer updates
+        bool isInterimZoomFrame;
+    };
+
+    void startFrameTrace();
+    std::vector<FrameTiming> stopFrameTrace();
+
+    FrameGovernor const& getFrameGovernor() const { return frameGovernor; }
+
+    // Rendering stops while the editor is minimised, hidden or fully covered by other windows
+    bool isSuspended() const;
+
     NVGcontext* getRawContext() { return nvg; }
 
     static NVGSurface* getSurfaceForContext(NVGcontext*);
@@ -104,7 +129,19 @@ public:
 private:
     
     float calculateRenderScale() const;
-    
+
+    // True if the next frame would draw anything, checked before any GL work happens
+    bool hasPendingWork() const;
+
+    void renderToMainFramebuffer(Rectangle<int> area, float pixelScale);
+    void blitFramebuffer(NVGframebuffer* source, NVGframebuffer* target, Rectangle<float> area, Point<float> offset, float pixelScale);
+    void scrollMainFramebuffer(float pixelScale);
+    void beginFramebufferFrame(NVGframebuffer* target, float pixelScale);
+
+    void captureZoomSnapshot(float pixelScale);
+    void renderZoomFrame(float pixelScale);
+    void deleteZoomFramebuffers();
+
     void resized() override;
 
     PluginEditor* editor;
@@ -113,6 +150,29 @@ private:
     std::unique_ptr<VBlankAttachment> vBlankAttachment;
 
     Rectangle<int> invalidArea;
+    Rectangle<int> scrollingArea;
+    Point<float> scrollDelta;
+    RectangleList<int> exposedAreas;
+
+    struct ZoomState {
+        Rectangle<int> area;
+        Point<float> snapshotOrigin, origin;
+        float snapshotScale = 1.0f, scale = 1.0f;
+        bool isActive = false;
+        bool needsCapture = false;
+        bool needsRender = false;
+    };
+
+    // Mip chain of the last full render, each level is half the size of the previous one
+    static constexpr int numZoomLevels = 4;
+    NVGframebuffer* zoomFBOs[numZoomLevels] = {};
+    ZoomState zoomState;
+
+    bool isTracingFrames = false;
+    std::vector<FrameTiming> frameTrace;
+
+    FrameGovernor frameGovernor;
+
     NVGframebuffer* mainFBO = nullptr;
     NVGframebuffer* invalidFBO = nullptr;
     int fbWidth = 0, fbHeight = 0;
@@ -124,6 +184,10 @@ private:
     Rectangle<int> newBounds;
 
     float lastRenderScale = 0.0f;
+    float lastPeerScale = 0.0f;
+
+    bool wasSuspended = false;
+    uint32 lastSuspendedFlush = 0;
     
 #if NANOVG_GL_IMPLEMENTATION
     std::unique_ptr<OpenGLContext> glContext;
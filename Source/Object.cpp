@@ -602,21 +602,34 @@ void Object::updateIoletGeometry()
     }
 }
 
-void Object::updateTooltips()
+void Object::invalidateTooltips()
 {
-    if (!gui || cnv->isGraph)
+    tooltipsResolved = false;
+
+    // Gem state changes how iolets and connections are drawn, so we can't wait for a hover there
+    // Subpatches and abstractions can declare gemlist iolets in their inlet comments, so they resolve right away too
+    // Abstractions are cheap to resolve after the first instance, because their comments are cached per file
+    if (isGemObject || (gui && gui->getPatch()))
+        resolveTooltips();
+}
+
+void Object::resolveTooltips()
+{
+    if (tooltipsResolved || !gui || cnv->isGraph)
         return;
 
-    auto objectInfo = cnv->pd->objectLibrary->getObjectInfo(gui->getTypeWithOriginPrefix());
+    auto* library = cnv->pd->objectLibrary.get();
 
-    std::array<StringArray, 2> ioletTooltips;
+    // Documentation that isn't indexed yet comes back empty, so try again on the next hover
+    tooltipsResolved = library->isDocumentationIndexed();
 
-    if (objectInfo.isValid()) {
-        // Set object tooltip
-        gui->setTooltip(objectInfo.getProperty("description").toString());
-        // Check pd library for pddp tooltips, those have priority
-        ioletTooltips = cnv->pd->objectLibrary->parseIoletTooltips(objectInfo.getChildWithName("iolets"), gui->getText(), numInputs, numOutputs);
-    }
+    auto documentation = library->getObjectDocumentation(gui->getTypeWithOriginPrefix());
+
+    // Set object tooltip
+    gui->setTooltip(documentation.description);
+
+    // Check pd library for pddp tooltips, those have priority
+    auto ioletTooltips = pd::Library::parseIoletTooltips(documentation, gui->getText(), numInputs, numOutputs);
 
     // First clear all tooltips, so we can see later if it has already been set or not
     for (auto iolet : iolets) {
@@ -627,7 +640,7 @@ void Object::updateTooltips()
     for (int i = 0; i < iolets.size(); i++) {
         auto* iolet = iolets[i];
 
-        auto& tooltip = ioletTooltips[!iolet->isInlet][iolet->isInlet ? i : i - numInputs];
+        auto const tooltip = ioletTooltips[!iolet->isInlet][iolet->isInlet ? i : i - numInputs];
         if (tooltip.startsWith("(gemlist)")) {
             iolet->isGemState = true;
             iolet->setTooltip("(gemlist)");
@@ -639,10 +652,14 @@ void Object::updateTooltips()
         }
     }
 
-    std::vector<std::pair<int, String>> inletMessages;
-    std::vector<std::pair<int, String>> outletMessages;
+    auto subpatch = gui->getPatch();
+    if (!subpatch)
+        return;
+
+    auto parseComments = [this, subpatch]() {
+        std::vector<std::pair<int, String>> inletMessages;
+        std::vector<std::pair<int, String>> outletMessages;
 
-    if (auto subpatch = gui->getPatch()) {
         cnv->pd->lockAudioThread();
         auto* subpatchPtr = subpatch->getPointer().get();
 
@@ -682,29 +699,37 @@ void Object::updateTooltips()
             }
         }
         cnv->pd->unlockAudioThread();
-    }
 
-    if (inletMessages.empty() && outletMessages.empty())
-        return;
+        auto sortFunc = [](std::pair<int, String>& a, std::pair<int, String>& b) {
+            return a.first < b.first;
+        };
+
+        std::sort(inletMessages.begin(), inletMessages.end(), sortFunc);
+        std::sort(outletMessages.begin(), outletMessages.end(), sortFunc);
 
-    auto sortFunc = [](std::pair<int, String>& a, std::pair<int, String>& b) {
-        return a.first < b.first;
+        std::array<StringArray, 2> comments;
+        for (auto& [x, message] : inletMessages)
+            comments[0].add(message);
+        for (auto& [x, message] : outletMessages)
+            comments[1].add(message);
+
+        return comments;
     };
 
-    std::sort(inletMessages.begin(), inletMessages.end(), sortFunc);
-    std::sort(outletMessages.begin(), outletMessages.end(), sortFunc);
+    // Abstractions share their comments with every other instance of the same file
+    auto const comments = subpatch->isSubpatch() ? parseComments() : library->getAbstractionIoletComments(subpatch->getPatchFile(), parseComments);
 
     int numIn = 0;
     int numOut = 0;
 
     for (auto iolet : iolets) {
-        if (iolet->getTooltip().isNotEmpty())
+        if (iolet->SettableTooltipClient::getTooltip().isNotEmpty())
             continue;
 
-        if ((iolet->isInlet && numIn >= inletMessages.size()) || (!iolet->isInlet && numOut >= outletMessages.size()))
+        if ((iolet->isInlet && numIn >= comments[0].size()) || (!iolet->isInlet && numOut >= comments[1].size()))
             continue;
 
-        auto& [x, message] = iolet->isInlet ? inletMessages[numIn++] : outletMessages[numOut++];
+        auto const& message = iolet->isInlet ? comments[0][numIn++] : comments[1][numOut++];
         iolet->setTooltip(message);
         iolet->isGemState = message.startsWith("(gemlist)");
     }
@@ -775,7 +800,7 @@ void Object::updateIolets()
     }
 
     if (tooltipsNeedUpdate)
-        updateTooltips();
+        invalidateTooltips();
     resized();
 }
 
@@ -837,6 +862,8 @@ void Object::mouseDown(MouseEvent const& e)
 
 void Object::mouseUp(MouseEvent const& e)
 {
+    cnv->inputCoalescer.flush();
+
     if (wasLockedOnMouseDown || (gui && gui->isEditorShown()))
         return;
 
@@ -944,7 +971,7 @@ void Object::mouseDrag(MouseEvent const& e)
     if (wasLockedOnMouseDown || (gui && gui->isEditorShown()))
         return;
 
-    if (cnv->objectRateReducer.tooFast())
+    if (cnv->inputCoalescer.coalesceDrag(this, e))
         return;
 
 #if JUCE_MAC || JUCE_WINDOWS
@@ -1087,12 +1114,16 @@ void Object::mouseDrag(MouseEvent const& e)
             cnv->patch.startUndoSequence("Snap");
 
             Array<Connection*> inputs, outputs;
-            for (auto* connection : cnv->connections) {
-                if (connection->inlet == object->iolets[0]) {
-                    inputs.add(connection);
+            if (auto* firstInlet = object->iolets[0]) {
+                for (auto* connection : firstInlet->getConnections()) {
+                    if (connection->inlet == firstInlet)
+                        inputs.add(connection);
                 }
-                if (connection->outlet == object->iolets[object->numInputs]) {
-                    outputs.add(connection);
+            }
+            if (auto* firstOutlet = object->iolets[object->numInputs]) {
+                for (auto* connection : firstOutlet->getConnections()) {
+                    if (connection->outlet == firstOutlet)
+                        outputs.add(connection);
                 }
             }
 
@@ -1367,7 +1398,13 @@ void Object::hideEditor()
 
 Array<Connection*> Object::getConnections() const
 {
+    int numConnections = 0;
+    for (auto* iolet : iolets) {
+        numConnections += iolet->getNumConnections();
+    }
+
     Array<Connection*> result;
+    result.ensureStorageAllocated(numConnections);
     for (auto* iolet : iolets) {
         result.addArray(iolet->getConnections());
     }
@@ -59,6 +59,9 @@ public:
 
     void updateIolets();
 
+    // Looks up the object and iolet tooltips, if they haven't been looked up since the iolets last changed
+    void resolveTooltips();
+
     void setType(String const& newType, pd::WeakReference existingObject = nullptr);
     void updateBounds();
     void applyBounds();
@@ -146,7 +149,8 @@ public:
 private:
     void initialise();
 
-    void updateTooltips();
+    // Tooltips are only looked up on first hover, doing this for every object makes opening large patches slow
+    void invalidateTooltips();
 
     void updateObjectActivityPolicy(String objectName);
 
@@ -161,6 +165,7 @@ private:
     bool wasLockedOnMouseDown = false;
     bool isHvccCompatible = true;
     bool isGemObject = false;
+    bool tooltipsResolved = false;
 
     float activeStateAlpha = 0.0f;
 
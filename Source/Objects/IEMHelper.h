@@ -33,19 +33,19 @@ public:
         secondaryColour = Colour(getBackgroundColour()).toString();
         labelColour = Colour(getLabelColour()).toString();
 
-        gui->getLookAndFeel().setColour(Label::textWhenEditingColourId, cnv->editor->getLookAndFeel().findColour(Label::textWhenEditingColourId));
-        gui->getLookAndFeel().setColour(Label::textColourId, Colour::fromString(primaryColour.toString()));
+        gui->getCustomLookAndFeel().setColour(Label::textWhenEditingColourId, cnv->editor->getLookAndFeel().findColour(Label::textWhenEditingColourId));
+        gui->getCustomLookAndFeel().setColour(Label::textColourId, Colour::fromString(primaryColour.toString()));
 
-        gui->getLookAndFeel().setColour(TextButton::buttonOnColourId, Colour::fromString(primaryColour.toString()));
-        gui->getLookAndFeel().setColour(Slider::thumbColourId, Colour::fromString(primaryColour.toString()));
+        gui->getCustomLookAndFeel().setColour(TextButton::buttonOnColourId, Colour::fromString(primaryColour.toString()));
+        gui->getCustomLookAndFeel().setColour(Slider::thumbColourId, Colour::fromString(primaryColour.toString()));
 
-        gui->getLookAndFeel().setColour(TextEditor::backgroundColourId, Colour::fromString(secondaryColour.toString()));
-        gui->getLookAndFeel().setColour(TextButton::buttonColourId, Colour::fromString(secondaryColour.toString()));
+        gui->getCustomLookAndFeel().setColour(TextEditor::backgroundColourId, Colour::fromString(secondaryColour.toString()));
+        gui->getCustomLookAndFeel().setColour(TextButton::buttonColourId, Colour::fromString(secondaryColour.toString()));
 
         auto sliderBackground = Colour::fromString(secondaryColour.toString());
         sliderBackground = sliderBackground.getBrightness() > 0.5f ? sliderBackground.darker(0.6f) : sliderBackground.brighter(0.6f);
 
-        gui->getLookAndFeel().setColour(Slider::backgroundColourId, sliderBackground);
+        gui->getCustomLookAndFeel().setColour(Slider::backgroundColourId, sliderBackground);
 
         if (auto iemgui = ptr.get<t_iemgui>()) {
             labelX = iemgui->x_ldx;
@@ -206,23 +206,23 @@ public:
             setForegroundColour(colour);
 
             // TODO: move this!
-            gui->getLookAndFeel().setColour(TextButton::buttonOnColourId, colour);
-            gui->getLookAndFeel().setColour(Slider::thumbColourId, colour);
-            gui->getLookAndFeel().setColour(Slider::trackColourId, colour);
+            gui->getCustomLookAndFeel().setColour(TextButton::buttonOnColourId, colour);
+            gui->getCustomLookAndFeel().setColour(Slider::thumbColourId, colour);
+            gui->getCustomLookAndFeel().setColour(Slider::trackColourId, colour);
 
-            gui->getLookAndFeel().setColour(Label::textColourId, colour);
-            gui->getLookAndFeel().setColour(Label::textWhenEditingColourId, colour);
-            gui->getLookAndFeel().setColour(TextEditor::textColourId, colour);
+            gui->getCustomLookAndFeel().setColour(Label::textColourId, colour);
+            gui->getCustomLookAndFeel().setColour(Label::textWhenEditingColourId, colour);
+            gui->getCustomLookAndFeel().setColour(TextEditor::textColourId, colour);
 
             gui->repaint();
         } else if (v.refersToSameSourceAs(secondaryColour)) {
             auto colour = Colour::fromString(secondaryColour.toString());
             setBackgroundColour(colour);
 
-            gui->getLookAndFeel().setColour(TextEditor::backgroundColourId, colour);
-            gui->getLookAndFeel().setColour(TextButton::buttonColourId, colour);
+            gui->getCustomLookAndFeel().setColour(TextEditor::backgroundColourId, colour);
+            gui->getCustomLookAndFeel().setColour(TextButton::buttonColourId, colour);
 
-            gui->getLookAndFeel().setColour(Slider::backgroundColourId, colour);
+            gui->getCustomLookAndFeel().setColour(Slider::backgroundColourId, colour);
 
             gui->repaint();
         } else if (v.refersToSameSourceAs(labelColour)) {
@@ -87,9 +87,9 @@ public:
         }
 
         auto fg = Colour::fromString(primaryColour.toString());
-        getLookAndFeel().setColour(Label::textColourId, fg);
-        getLookAndFeel().setColour(Label::textWhenEditingColourId, fg);
-        getLookAndFeel().setColour(TextEditor::textColourId, fg);
+        getCustomLookAndFeel().setColour(Label::textColourId, fg);
+        getCustomLookAndFeel().setColour(Label::textWhenEditingColourId, fg);
+        getCustomLookAndFeel().setColour(TextEditor::textColourId, fg);
     }
 
     Rectangle<int> getPdBounds() override
@@ -237,9 +237,9 @@ public:
         }
 
         auto col = Colour::fromString(colour);
-        getLookAndFeel().setColour(Label::textColourId, col);
-        getLookAndFeel().setColour(Label::textWhenEditingColourId, col);
-        getLookAndFeel().setColour(TextEditor::textColourId, col);
+        getCustomLookAndFeel().setColour(Label::textColourId, col);
+        getCustomLookAndFeel().setColour(Label::textWhenEditingColourId, col);
+        getCustomLookAndFeel().setColour(TextEditor::textColourId, col);
 
         repaint();
     }
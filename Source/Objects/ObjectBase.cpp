@@ -119,7 +119,8 @@ void ObjectBase::ObjectSizeListener::valueChanged(Value& v)
     }
 }
 
-ObjectBase::PropertyUndoListener::PropertyUndoListener()
+ObjectBase::PropertyUndoListener::PropertyUndoListener(ObjectBase* parent)
+    : parent(parent)
 {
     lastChange = Time::getMillisecondCounter();
 }
@@ -127,7 +128,11 @@ ObjectBase::PropertyUndoListener::PropertyUndoListener()
 void ObjectBase::PropertyUndoListener::valueChanged(Value& v)
 {
     if (Time::getMillisecondCounter() - lastChange > 400) {
-        onChange();
+        if (auto obj = parent->ptr.get<t_gobj>()) {
+            if (auto* canvas = parent->cnv->patch.getPointer().get()) {
+                pd::Interface::undoApply(canvas, obj.get());
+            }
+        }
     }
 
     lastChange = Time::getMillisecondCounter();
@@ -139,47 +144,49 @@ ObjectBase::ObjectBase(pd::WeakReference obj, Object* parent)
     , object(parent)
     , cnv(parent->cnv)
     , pd(parent->cnv->pd)
+    , propertyUndoListener(this)
     , objectSizeListener(parent)
 {
     // Perform async, so that we don't get a size change callback for initial creation
-    MessageManager::callAsync([_this = SafePointer(this)](){
-        if(!_this) return;
-        _this->object->addComponentListener(&_this->objectSizeListener);
-        _this->updateLabel();
-    });
-    
+    cnv->deferObjectInitialisation(this);
+
     setWantsKeyboardFocus(true);
 
-    setLookAndFeel(new PlugDataLook());
+    if (!pd->objectLnf)
+        pd->objectLnf = std::make_unique<PlugDataLook>();
+
+    setLookAndFeel(pd->objectLnf.get());
 
     auto objectBounds = object->getObjectBounds();
     positionParameter = Array<var> { var(objectBounds.getX()), var(objectBounds.getY()) };
 
     objectParameters.addParamPosition(&positionParameter);
     positionParameter.addListener(&objectSizeListener);
-
-    propertyUndoListener.onChange = [_this = SafePointer(this)]() {
-        if (!_this)
-            return;
-
-        if (auto obj = _this->ptr.get<t_gobj>()) {
-            auto* canvas = _this->cnv->patch.getPointer().get();
-            if (!canvas)
-                return;
-
-            pd::Interface::undoApply(canvas, obj.get());
-        }
-    };
 }
 
 ObjectBase::~ObjectBase()
 {
+    cnv->cancelDeferredInitialisation(this);
     pd->unregisterMessageListener(ptr.getRawUnchecked<void>(), this);
     object->removeComponentListener(&objectSizeListener);
 
-    auto* lnf = &getLookAndFeel();
     setLookAndFeel(nullptr);
-    delete lnf;
+}
+
+void ObjectBase::initialiseDeferred()
+{
+    object->addComponentListener(&objectSizeListener);
+    updateLabel();
+}
+
+LookAndFeel& ObjectBase::getCustomLookAndFeel()
+{
+    if (!customLookAndFeel) {
+        customLookAndFeel = std::make_unique<PlugDataLook>();
+        setLookAndFeel(customLookAndFeel.get());
+    }
+
+    return *customLookAndFeel;
 }
 
 void ObjectBase::initialise()
@@ -302,6 +309,12 @@ String ObjectBase::getType() const
     return {};
 }
 
+String ObjectBase::getTooltip()
+{
+    object->resolveTooltips();
+    return SettableTooltipClient::getTooltip();
+}
+
 // Make sure the object can't be triggered if that palette is in drag mode
 bool ObjectBase::hitTest(int x, int y)
 {
@@ -485,6 +498,9 @@ void ObjectBase::startEdition()
 
 void ObjectBase::stopEdition()
 {
+    // Make sure the last value of the gesture reaches pd before the gesture ends
+    cnv->inputCoalescer.flush();
+
     if (!edited)
         return;
 
@@ -495,6 +511,19 @@ void ObjectBase::stopEdition()
 }
 
 void ObjectBase::sendFloatValue(float newValue)
+{
+    // While a gui is being edited, only its latest value is sent to pd, once per frame
+    if (edited) {
+        cnv->inputCoalescer.coalesce(this, [this, newValue]() {
+            sendFloatValueNow(newValue);
+        });
+        return;
+    }
+
+    sendFloatValueNow(newValue);
+}
+
+void ObjectBase::sendFloatValueNow(float newValue)
 {
     t_atom atom;
     SETFLOAT(&atom, newValue);
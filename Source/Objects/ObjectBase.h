@@ -203,12 +203,12 @@ class ObjectBase : public Component
     };
 
     struct PropertyUndoListener : public Value::Listener {
-        PropertyUndoListener();
+        explicit PropertyUndoListener(ObjectBase* parent);
 
         void valueChanged(Value& v) override;
 
+        ObjectBase* parent;
         uint32 lastChange;
-        std::function<void()> onChange = []() {};
     };
 
 public:
@@ -218,6 +218,12 @@ public:
 
     void initialise();
 
+    // Setup that has to wait until the object has its initial size, called by the canvas for all new objects at once
+    void initialiseDeferred();
+
+    // Objects share a look and feel, this gives the object its own so it can set colours on it
+    LookAndFeel& getCustomLookAndFeel();
+
     void paint(Graphics& g) override;
 
     // Functions to show and hide a text editor
@@ -230,6 +236,8 @@ public:
 
     bool hitTest(int x, int y) override;
 
+    String getTooltip() override;
+
     // Some objects need to show/hide iolets when send/receive symbols are set
     virtual bool inletIsSymbol() { return false; }
     virtual bool outletIsSymbol() { return false; }
@@ -339,6 +347,7 @@ protected:
 
     // Send a float value to Pd
     void sendFloatValue(float value);
+    void sendFloatValueNow(float value);
 
     // Gets the scale factor we need to use of we want to draw images inside the component
     float getImageScale();
@@ -388,6 +397,8 @@ public:
 protected:
     PropertyUndoListener propertyUndoListener;
 
+    std::unique_ptr<LookAndFeel> customLookAndFeel;
+
     NVGImage imageRenderer;
 
     std::function<void()> onConstrainerCreate = []() {};
@@ -0,0 +1,418 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "Utility/Config.h"
+
+#include "HeadlessInstance.h"
+#include "Library.h"
+#include "MessageListener.h"
+
+extern "C" {
+#include <z_libpd.h>
+}
+
+#if PLUGDATA_HEADLESS
+// The headless engine doesn't link Config.cpp, since that depends on the standalone and plugin wrappers
+char const* ProjectInfo::projectName = "plugdata-headless";
+bool ProjectInfo::isStandalone = false;
+bool ProjectInfo::isFx = false;
+#endif
+
+namespace pd {
+
+HeadlessInstance::HeadlessInstance(int const numIns, int const numOuts, double const sampleRate)
+    : numInputs(numIns)
+    , numOutputs(numOuts)
+{
+    // Make sure to use dots for decimal numbers, pd requires that
+    std::setlocale(LC_ALL, "C");
+
+    if (!ProjectInfo::versionDataDir.isDirectory()) {
+        logWarning("plugdata data directory not found, abstractions and externals won't be available until plugdata has been launched once");
+    }
+
+    String pdlua_version;
+    initialisePd(pdlua_version);
+
+    updateSearchPaths();
+
+    auto const blockSize = Instance::getBlockSize();
+    audioVectorIn.resize(std::max(numInputs, 1) * blockSize, 0.0f);
+    audioVectorOut.resize(std::max(numOutputs, 1) * blockSize, 0.0f);
+    midiBufferOut.ensureSize(2048);
+
+    latencySamples = blockSize;
+
+    prepareDSP(numInputs, numOutputs, sampleRate, blockSize);
+    startDSP();
+}
+
+HeadlessInstance::~HeadlessInstance()
+{
+    library.reset();
+
+    // Close patches while the instance is still alive
+    lockAudioThread();
+    patches.clear();
+    unlockAudioThread();
+}
+
+void HeadlessInstance::updateSearchPaths()
+{
+    setThis();
+
+    lockAudioThread();
+
+    libpd_clear_search_path();
+    for (auto const& path : pd::Library::defaultPaths) {
+        libpd_add_to_search_path(path.getFullPathName().replace("\\", "/").toRawUTF8());
+    }
+
+    unlockAudioThread();
+}
+
+Patch::Ptr HeadlessInstance::loadPatch(File const& patchFile)
+{
+    auto newPatch = openPatch(patchFile, usePatchCache);
+
+    if (!newPatch->getPointer()) {
+        logError("Couldn't open patch: " + patchFile.getFullPathName());
+        return nullptr;
+    }
+
+    patches.add(newPatch);
+    newPatch->setCurrentFile(URL(patchFile));
+
+    return newPatch;
+}
+
+Patch::Ptr HeadlessInstance::loadPatch(String const& patchContent)
+{
+    auto patchFile = File::createTempFile(".pd");
+    patchFile.replaceWithText(patchContent.isEmpty() ? pd::Instance::defaultPatch : patchContent);
+
+    auto patch = loadPatch(patchFile);
+    patchFile.deleteFile();
+
+    // Set to unknown file when loading temp patch
+    if (patch)
+        patch->setCurrentFile(URL("file://"));
+
+    return patch;
+}
+
+void HeadlessInstance::closePatch(Patch::Ptr const& patch)
+{
+    lockAudioThread();
+    patches.removeAllInstancesOf(patch);
+    unlockAudioThread();
+}
+
+void HeadlessInstance::process(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    auto const blockSize = Instance::getBlockSize();
+    auto const numSamples = buffer.getNumSamples();
+
+    // Pd only processes whole blocks
+    jassert(numSamples % blockSize == 0);
+
+    midiBufferOut.clear();
+    audioAdvancement = 0;
+
+    setThis();
+
+    while (audioAdvancement + blockSize <= numSamples) {
+        for (int ch = 0; ch < std::min(numInputs, buffer.getNumChannels()); ch++) {
+            FloatVectorOperations::copy(audioVectorIn.data() + (ch * blockSize), buffer.getReadPointer(ch, audioAdvancement), blockSize);
+        }
+
+        // Send MIDI that falls within this Pd block
+        auto const receivers = getMidiReceivers();
+        if (receivers.any()) {
+            for (auto it = midiMessages.findNextSamplePosition(audioAdvancement); it != midiMessages.end(); ++it) {
+                auto const event = *it;
+                if (event.samplePosition >= audioAdvancement + blockSize)
+                    break;
+
+                sendMidiEvent(receivers, event.data, event.numBytes, 0, event.samplePosition - audioAdvancement);
+            }
+        }
+
+        performDSP(audioVectorIn.data(), audioVectorOut.data());
+
+        sendMessagesFromQueue();
+
+        for (int ch = 0; ch < std::min(numOutputs, buffer.getNumChannels()); ch++) {
+            FloatVectorOperations::copy(buffer.getWritePointer(ch, audioAdvancement), audioVectorOut.data() + (ch * blockSize), blockSize);
+        }
+
+        audioAdvancement += blockSize;
+    }
+
+    midiMessages.swapWith(midiBufferOut);
+}
+
+void HeadlessInstance::poll()
+{
+    // Without a running message loop, AsyncUpdaters can't deliver their callbacks, so we call them ourselves
+    handleAsyncUpdate();
+    consoleHandler.handleAsyncUpdate();
+
+    setThis();
+    messageDispatcher->dequeueMessages();
+}
+
+void HeadlessInstance::runEventLoop(int const pollIntervalMs)
+{
+    shouldStopEventLoop = false;
+
+    while (!shouldStopEventLoop) {
+        poll();
+
+        // Services callAsync and timer callbacks that Pd deferred to the message thread
+        if (!MessageManager::getInstance()->runDispatchLoopUntil(pollIntervalMs))
+            break;
+    }
+
+    poll();
+}
+
+void HeadlessInstance::stopEventLoop()
+{
+    shouldStopEventLoop = true;
+}
+
+void HeadlessInstance::setParameter(String const& name, float const value)
+{
+    float clampedValue;
+    {
+        ScopedLock const lock(parameterLock);
+        auto const it = parameters.find(name);
+        if (it == parameters.end())
+            return;
+
+        auto& parameter = it->second;
+        clampedValue = parameter.value = std::clamp(value, parameter.min, parameter.max);
+    }
+
+    lockAudioThread();
+    sendFloat(name.toRawUTF8(), clampedValue);
+    unlockAudioThread();
+}
+
+float HeadlessInstance::getParameter(String const& name) const
+{
+    ScopedLock const lock(parameterLock);
+    auto const it = parameters.find(name);
+    return it != parameters.end() ? it->second.value : 0.0f;
+}
+
+StringArray HeadlessInstance::getParameterNames() const
+{
+    ScopedLock const lock(parameterLock);
+
+    StringArray names;
+    for (auto const& [name, parameter] : parameters) {
+        names.add(name);
+    }
+
+    return names;
+}
+
+int HeadlessInstance::getLatencySamples() const
+{
+    return latencySamples;
+}
+
+Library& HeadlessInstance::getLibrary()
+{
+    if (!library)
+        library = std::make_unique<pd::Library>(this);
+
+    return *library;
+}
+
+NamedValueSet HeadlessInstance::getMemoryUsage()
+{
+    auto usage = Instance::getMemoryUsage();
+
+    if (library)
+        usage.set("library", static_cast<int64>(library->getMemoryUsage()));
+
+    return usage;
+}
+
+void HeadlessInstance::receiveNoteOn(int const channel, int const pitch, int const velocity)
+{
+    // Without a device manager, all devices are merged into one MIDI stream
+    auto const device = (channel - 1) >> 4;
+    auto const deviceChannel = channel - (device * 16);
+
+    if (velocity == 0) {
+        midiBufferOut.addEvent(MidiMessage::noteOff(deviceChannel, pitch, uint8(0)), audioAdvancement);
+    } else {
+        midiBufferOut.addEvent(MidiMessage::noteOn(deviceChannel, pitch, static_cast<uint8>(velocity)), audioAdvancement);
+    }
+}
+
+void HeadlessInstance::receiveControlChange(int const channel, int const controller, int const value)
+{
+    auto const deviceChannel = channel - ((channel >> 4) * 16);
+    midiBufferOut.addEvent(MidiMessage::controllerEvent(deviceChannel, controller, value), audioAdvancement);
+}
+
+void HeadlessInstance::receiveProgramChange(int const channel, int const value)
+{
+    auto const deviceChannel = channel - ((channel >> 4) * 16);
+    midiBufferOut.addEvent(MidiMessage::programChange(deviceChannel, value), audioAdvancement);
+}
+
+void HeadlessInstance::receivePitchBend(int const channel, int const value)
+{
+    auto const deviceChannel = channel - ((channel >> 4) * 16);
+    midiBufferOut.addEvent(MidiMessage::pitchWheel(deviceChannel, value + 8192), audioAdvancement);
+}
+
+void HeadlessInstance::receiveAftertouch(int const channel, int const value)
+{
+    auto const deviceChannel = channel - ((channel >> 4) * 16);
+    midiBufferOut.addEvent(MidiMessage::channelPressureChange(deviceChannel, value), audioAdvancement);
+}
+
+void HeadlessInstance::receivePolyAftertouch(int const channel, int const pitch, int const value)
+{
+    auto const deviceChannel = channel - ((channel >> 4) * 16);
+    midiBufferOut.addEvent(MidiMessage::aftertouchChange(deviceChannel, pitch, value), audioAdvancement);
+}
+
+void HeadlessInstance::receiveMidiByte(int const port, int const byte)
+{
+    ignoreUnused(port);
+
+    if (midiByteIsSysex) {
+        if (byte == 0xf7) {
+            midiBufferOut.addEvent(MidiMessage::createSysExMessage(midiByteBuffer, static_cast<int>(midiByteIndex)), audioAdvancement);
+            midiByteIndex = 0;
+            midiByteIsSysex = false;
+        } else {
+            midiByteBuffer[midiByteIndex++] = static_cast<uint8>(byte);
+            if (midiByteIndex == 512) {
+                midiByteIndex = 511;
+            }
+        }
+    } else if (midiByteIndex == 0 && byte == 0xf0) {
+        midiByteIsSysex = true;
+    } else {
+        // Handle single-byte messages
+        if (midiByteIndex == 0 && byte >= 0xf8 && byte <= 0xff) {
+            midiBufferOut.addEvent(MidiMessage(static_cast<uint8>(byte)), audioAdvancement);
+        }
+        // Handle 3-byte messages
+        else {
+            midiByteBuffer[midiByteIndex++] = static_cast<uint8>(byte);
+            if (midiByteIndex >= 3) {
+                midiBufferOut.addEvent(MidiMessage(midiByteBuffer, 3), audioAdvancement);
+                midiByteIndex = 0;
+            }
+        }
+    }
+}
+
+void HeadlessInstance::receiveSysMessage(String const& selector, std::vector<pd::Atom> const& list)
+{
+    switch (hash(selector)) {
+    case hash("open"): {
+        if (list.size() >= 2) {
+            auto filename = list[0].toString();
+            auto directory = list[1].toString();
+            loadPatch(File(directory).getChildFile(filename));
+        }
+        break;
+    }
+    case hash("quit"):
+    case hash("verifyquit"): {
+        stopEventLoop();
+        break;
+    }
+    default:
+        break;
+    }
+
+    if (onSystemMessage)
+        onSystemMessage(selector, list);
+}
+
+void HeadlessInstance::updateConsole(int const numMessages, bool newWarning)
+{
+    if (!onConsoleMessage)
+        return;
+
+    auto& messages = getConsoleMessages();
+    auto const first = std::max<int>(0, static_cast<int>(messages.size()) - numMessages);
+
+    for (int i = first; i < static_cast<int>(messages.size()); i++) {
+        auto& [object, message, type, length, repeats] = messages[i];
+        onConsoleMessage(message, type);
+    }
+}
+
+void HeadlessInstance::performParameterChange(int const type, String const& name, float const value)
+{
+    // Type == 1 means it sets the change gesture state, which only matters to a host
+    if (type)
+        return;
+
+    {
+        ScopedLock const lock(parameterLock);
+        auto const it = parameters.find(name);
+        if (it == parameters.end())
+            return;
+
+        it->second.value = value;
+    }
+
+    if (onParameterChange)
+        onParameterChange(name, value);
+}
+
+void HeadlessInstance::enableAudioParameter(String const& name)
+{
+    ScopedLock const lock(parameterLock);
+    parameters.try_emplace(name);
+}
+
+void HeadlessInstance::setParameterRange(String const& name, float const min, float const max)
+{
+    ScopedLock const lock(parameterLock);
+    auto& parameter = parameters[name];
+    parameter.min = min;
+    parameter.max = std::max(max, min + 0.000001f);
+}
+
+void HeadlessInstance::setParameterMode(String const& name, int const mode)
+{
+    ScopedLock const lock(parameterLock);
+    parameters[name].mode = std::clamp<int>(mode, 1, 4);
+}
+
+void HeadlessInstance::performLatencyCompensationChange(float const value)
+{
+    latencySamples = static_cast<int>(value) + Instance::getBlockSize();
+}
+
+void HeadlessInstance::reloadAbstractions(File changedPatch, t_glist* except)
+{
+    setThis();
+
+    // Ensure that all messages are dequeued before we start deleting objects
+    sendMessagesFromQueue();
+
+    isPerformingGlobalSync = true;
+    pd::Patch::reloadPatch(changedPatch, except);
+    isPerformingGlobalSync = false;
+}
+
+} // namespace pd
@@ -0,0 +1,120 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "Instance.h"
+
+namespace pd {
+
+class Library;
+
+// Pd instance that runs without plugdata's GUI, an AudioProcessor or a running JUCE message loop
+// This lets servers and batch processes embed plugdata's engine and patch set
+// The owner drives audio by calling process(), and handles everything Pd sends back to plugdata by calling poll() from its own loop
+class HeadlessInstance : public Instance {
+public:
+    HeadlessInstance(int numInputs, int numOutputs, double sampleRate);
+
+    ~HeadlessInstance() override;
+
+    // Opens a patch and keeps it alive until closePatch() is called or this instance is deleted
+    Patch::Ptr loadPatch(File const& patchFile);
+    Patch::Ptr loadPatch(String const& patchContent);
+    void closePatch(Patch::Ptr const& patch);
+
+    // Processes audio and MIDI, the number of samples must be a multiple of Pd's block size
+    // Incoming MIDI in midiMessages is replaced by the MIDI that Pd sent out during this block
+    void process(AudioBuffer<float>& buffer, MidiBuffer& midiMessages);
+
+    // Dispatches messages that Pd sent to plugdata since the last call: console output, parameter changes and "pd" messages
+    // Never blocks, call this regularly from whatever thread owns the instance
+    void poll();
+
+    // Keeps calling poll() until stopEventLoop() is called, or Pd receives a "quit" message
+    // Also services work that Pd deferred to the JUCE message queue, so the calling thread becomes the message thread
+    void runEventLoop(int pollIntervalMs = 10);
+    void stopEventLoop();
+
+    // Sets the value of a parameter created with [param] or [receive paramN] in the patch, clamped to its range
+    // Names the patch didn't create a parameter for are ignored
+    void setParameter(String const& name, float value);
+    float getParameter(String const& name) const;
+    StringArray getParameterNames() const;
+
+    int getLatencySamples() const;
+
+    // Read patches through a binary .pdc sidecar cache, see PatchCache
+    bool usePatchCache = false;
+
+    // The object library is only indexed when it's first needed, since it's expensive to build
+    Library& getLibrary();
+
+    NamedValueSet getMemoryUsage() override;
+
+    std::function<void(String const& message, bool isError)> onConsoleMessage;
+    std::function<void(String const& name, float value)> onParameterChange;
+    std::function<void(String const& selector, std::vector<pd::Atom> const& list)> onSystemMessage;
+
+    void receiveNoteOn(int channel, int pitch, int velocity) override;
+    void receiveControlChange(int channel, int controller, int value) override;
+    void receiveProgramChange(int channel, int value) override;
+    void receivePitchBend(int channel, int value) override;
+    void receiveAftertouch(int channel, int value) override;
+    void receivePolyAftertouch(int channel, int pitch, int value) override;
+    void receiveMidiByte(int port, int byte) override;
+    void receiveSysMessage(String const& selector, std::vector<pd::Atom> const& list) override;
+
+    void updateConsole(int numMessages, bool newWarning) override;
+    void titleChanged() override { }
+
+    void performParameterChange(int type, String const& name, float value) override;
+    void enableAudioParameter(String const& name) override;
+    void setParameterRange(String const& name, float min, float max) override;
+    void setParameterMode(String const& name, int mode) override;
+    void performLatencyCompensationChange(float value) override;
+
+    // The DAW data buffer only makes sense inside a host session
+    void fillDataBuffer(std::vector<pd::Atom> const& list) override { }
+    void parseDataBuffer(XmlElement const& xml) override { }
+
+    void reloadAbstractions(File changedPatch, t_glist* except) override;
+
+private:
+    void updateSearchPaths();
+
+    struct Parameter {
+        float value = 0.0f;
+        float min = 0.0f;
+        float max = 1.0f;
+        int mode = 1;
+    };
+
+    std::map<String, Parameter> parameters;
+    CriticalSection parameterLock;
+
+    std::unique_ptr<Library> library;
+
+    int numInputs, numOutputs;
+    std::vector<float> audioVectorIn;
+    std::vector<float> audioVectorOut;
+
+    MidiBuffer midiBufferOut;
+    int audioAdvancement = 0;
+
+    bool midiByteIsSysex = false;
+    uint8 midiByteBuffer[512] = { 0 };
+    size_t midiByteIndex = 0;
+
+    std::atomic<int> latencySamples = 0;
+    std::atomic<bool> shouldStopEventLoop = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeadlessInstance)
+};
+
+} // namespace pd
@@ -4,18 +4,13 @@
  // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
  */
 
-#include <juce_gui_basics/juce_gui_basics.h>
-
 #include "Utility/Config.h"
-#include "Utility/Fonts.h"
-#include "Dialogs/Dialogs.h"
 
 #include <algorithm>
+#include <thread>
 #include "Instance.h"
 #include "Patch.h"
 #include "MessageListener.h"
-#include "Objects/ImplementationBase.h"
-#include "Utility/SettingsFile.h"
 
 extern "C" {
 
@@ -30,42 +25,54 @@ EXTERN int sys_load_lib(t_canvas* canvas, char const* classname);
 
 struct pd::Instance::internal {
 
+    // Called from pd, so gensym() uses the symbol table of the right instance
+    static Message createMessage(pd::Instance* ptr, char const* recv, char const* selector, int argc)
+    {
+        Message mess;
+        mess.selector = gensym(selector);
+        mess.destination = gensym(recv);
+        mess.size = argc;
+        if (argc > Message::maxInlineAtoms) {
+            mess.overflow = ptr->atomBufferPool.acquire(argc);
+        }
+        return mess;
+    }
+
     static void instance_multi_bang(pd::Instance* ptr, char const* recv)
     {
-        ptr->enqueueGuiMessage({ String("bang"), String::fromUTF8(recv) });
+        ptr->enqueueGuiMessage(createMessage(ptr, recv, "bang", 0));
     }
 
     static void instance_multi_float(pd::Instance* ptr, char const* recv, float f)
     {
-        ptr->enqueueGuiMessage({ String("float"), String::fromUTF8(recv), std::vector<Atom>(1, { f }) });
+        auto mess = createMessage(ptr, recv, "float", 1);
+        mess.atoms[0] = Atom(f);
+        ptr->enqueueGuiMessage(mess);
     }
 
     static void instance_multi_symbol(pd::Instance* ptr, char const* recv, char const* sym)
     {
-        ptr->enqueueGuiMessage({ String("symbol"), String::fromUTF8(recv), std::vector<Atom>(1, ptr->generateSymbol(sym)) });
+        auto mess = createMessage(ptr, recv, "symbol", 1);
+        mess.atoms[0] = Atom(gensym(sym));
+        ptr->enqueueGuiMessage(mess);
     }
 
     static void instance_multi_list(pd::Instance* ptr, char const* recv, int argc, t_atom* argv)
     {
-        Message mess { String("list"), String::fromUTF8(recv), std::vector<Atom>(argc) };
-        for (int i = 0; i < argc; ++i) {
-            if (argv[i].a_type == A_FLOAT)
-                mess.list[i] = Atom(atom_getfloat(argv + i));
-            else if (argv[i].a_type == A_SYMBOL)
-                mess.list[i] = Atom(atom_getsymbol(argv + i));
-        }
-
-        ptr->enqueueGuiMessage(mess);
+        instance_multi_message(ptr, recv, "list", argc, argv);
     }
 
     static void instance_multi_message(pd::Instance* ptr, char const* recv, char const* msg, int argc, t_atom* argv)
     {
-        Message mess { msg, String::fromUTF8(recv), std::vector<Atom>(argc) };
+        auto mess = createMessage(ptr, recv, msg, argc);
+        auto* atoms = mess.overflow ? mess.overflow->data() : mess.atoms;
         for (int i = 0; i < argc; ++i) {
             if (argv[i].a_type == A_FLOAT)
-                mess.list[i] = Atom(atom_getfloat(argv + i));
+                atoms[i] = Atom(atom_getfloat(argv + i));
             else if (argv[i].a_type == A_SYMBOL)
-                mess.list[i] = Atom(atom_getsymbol(argv + i));
+                atoms[i] = Atom(atom_getsymbol(argv + i));
+            else
+                atoms[i] = Atom();
         }
         ptr->enqueueGuiMessage(mess);
     }
@@ -133,13 +140,13 @@ Instance::Instance()
     , consoleHandler(this)
 {
     pd::Setup::initialisePd();
-    objectImplementations = std::make_unique<::ObjectImplementationManager>(this);
 }
 
 Instance::~Instance()
 {
-    objectImplementations.reset(nullptr); // Make sure it gets deallocated before pd instance gets deleted
-    
+    // Pending writes may still refer to our patches
+    patchWriter->waitForPendingWrites();
+
     pd_free(static_cast<t_pd*>(messageReceiver));
     pd_free(static_cast<t_pd*>(midiReceiver));
     pd_free(static_cast<t_pd*>(printReceiver));
@@ -164,33 +171,37 @@ void Instance::initialisePd(String& pdlua_version)
 
     libpd_set_instance(static_cast<t_pdinstance*>(instance));
 
+    // Locks taken by pd itself show up in the lock telemetry as this call site
     setup_lock(
-        static_cast<void const*>(&audioLock),
-        [](void* lock) {
-            static_cast<CriticalSection*>(lock)->enter();
+        static_cast<void const*>(this),
+        [](void* instance) {
+            static_cast<Instance*>(instance)->lockAudioThread();
         },
-        [](void* lock) {
-            static_cast<CriticalSection*>(lock)->exit();
+        [](void* instance) {
+            static_cast<Instance*>(instance)->unlockAudioThread();
         });
 
     setup_weakreferences(
         [](void* instance, void* ref) {
-            static_cast<pd::Instance*>(instance)->clearWeakReferences(ref);
+            static_cast<pd::Instance*>(instance)->weakReferences.invalidate(ref);
         },
         [](void* instance, void* ref, void* weakref) {
-            auto** reference_state = reinterpret_cast<pd_weak_reference**>(weakref);
-            *reference_state = new pd_weak_reference(true);
-            static_cast<pd::Instance*>(instance)->registerWeakReference(ref, *reference_state);
+            auto** reference_state = reinterpret_cast<WeakReferenceRegistry::Handle**>(weakref);
+            *reference_state = new WeakReferenceRegistry::Handle(static_cast<pd::Instance*>(instance)->weakReferences.getHandle(ref));
         },
         [](void* instance, void* ref, void* weakref) {
-            auto** reference_state = reinterpret_cast<pd_weak_reference**>(weakref);
-            static_cast<pd::Instance*>(instance)->unregisterWeakReference(ref, *reference_state);
+            auto** reference_state = reinterpret_cast<WeakReferenceRegistry::Handle**>(weakref);
             delete *reference_state;
         },
         [](void* ref) -> int {
-            return ((pd_weak_reference*)ref)->load();
+            return static_cast<WeakReferenceRegistry::Handle*>(ref)->isValid();
         });
 
+    // Symbols belong to the pd instance, so we only have to look them up once
+    for (auto [index, name] : std::initializer_list<std::pair<int, char const*>> { { NoteIn, "#notein" }, { CtlIn, "#ctlin" }, { PgmIn, "#pgmin" }, { BendIn, "#bendin" }, { TouchIn, "#touchin" }, { PolyTouchIn, "#polytouchin" }, { SysexIn, "#sysexin" }, { RealtimeIn, "#midirealtimein" }, { MidiIn, "#midiin" }, { MidiOffset, "midi_offset" } }) {
+        midiReceiverSymbols[index] = gensym(name);
+    }
+
     midiReceiver = pd::Setup::createMIDIHook(this, reinterpret_cast<t_plugdata_noteonhook>(internal::instance_multi_noteon), reinterpret_cast<t_plugdata_controlchangehook>(internal::instance_multi_controlchange), reinterpret_cast<t_plugdata_programchangehook>(internal::instance_multi_programchange),
         reinterpret_cast<t_plugdata_pitchbendhook>(internal::instance_multi_pitchbend), reinterpret_cast<t_plugdata_aftertouchhook>(internal::instance_multi_aftertouch), reinterpret_cast<t_plugdata_polyaftertouchhook>(internal::instance_multi_polyaftertouch),
         reinterpret_cast<t_plugdata_midibytehook>(internal::instance_multi_midibyte));
@@ -417,6 +428,113 @@ void Instance::sendMidiByte(int const port, int const byte) const
     libpd_midibyte(port, byte);
 }
 
+Instance::MidiReceivers Instance::getMidiReceivers() const
+{
+    auto const isBound = [this](MidiReceiverSymbol const symbol) {
+        return midiReceiverSymbols[symbol] && midiReceiverSymbols[symbol]->s_thing;
+    };
+
+    MidiReceivers receivers;
+    receivers.notein = isBound(NoteIn);
+    receivers.ctlin = isBound(CtlIn);
+    receivers.pgmin = isBound(PgmIn);
+    receivers.bendin = isBound(BendIn);
+    receivers.touchin = isBound(TouchIn);
+    receivers.polytouchin = isBound(PolyTouchIn);
+    receivers.sysexin = isBound(SysexIn);
+    receivers.realtimein = isBound(RealtimeIn);
+    receivers.midiin = isBound(MidiIn);
+    receivers.offset = isBound(MidiOffset);
+    return receivers;
+}
+
+void Instance::sendMidiEvent(MidiReceivers const& receivers, uint8 const* data, int const size, int const port, int const sampleOffset) const
+{
+    if (size <= 0)
+        return;
+
+    // The offset only goes out right before something is actually sent, so it always belongs to the next event pd sees
+    bool offsetSent = !receivers.offset;
+    auto const sendOffset = [this, &offsetSent, sampleOffset]() {
+        if (!offsetSent) {
+            pd_float(midiReceiverSymbols[MidiOffset]->s_thing, static_cast<t_float>(sampleOffset * 1000.0 / sys_getsr()));
+            offsetSent = true;
+        }
+    };
+
+    auto const status = data[0];
+    auto const channel = (status & 0x0f) + (port << 4);
+
+    switch (status & 0xf0) {
+    case 0x80:
+        if (receivers.notein && size >= 3) {
+            sendOffset();
+            libpd_noteon(channel, data[1], 0);
+        }
+        break;
+    case 0x90:
+        if (receivers.notein && size >= 3) {
+            sendOffset();
+            libpd_noteon(channel, data[1], data[2]);
+        }
+        break;
+    case 0xa0:
+        if (receivers.polytouchin && size >= 3) {
+            sendOffset();
+            libpd_polyaftertouch(channel, data[1], data[2]);
+        }
+        break;
+    case 0xb0:
+        if (receivers.ctlin && size >= 3) {
+            sendOffset();
+            libpd_controlchange(channel, data[1], data[2]);
+        }
+        break;
+    case 0xc0:
+        if (receivers.pgmin && size >= 2) {
+            sendOffset();
+            libpd_programchange(channel, data[1]);
+        }
+        break;
+    case 0xd0:
+        if (receivers.touchin && size >= 2) {
+            sendOffset();
+            libpd_aftertouch(channel, data[1]);
+        }
+        break;
+    case 0xe0:
+        if (receivers.bendin && size >= 3) {
+            sendOffset();
+            libpd_pitchbend(channel, (data[1] | (data[2] << 7)) - 8192);
+        }
+        break;
+    default:
+        if (status == 0xf0) {
+            // Like before, sysexin gets the data without the 0xf0 and 0xf7 framing
+            auto const end = data[size - 1] == 0xf7 ? size - 1 : size;
+            if (receivers.sysexin && end > 1) {
+                sendOffset();
+                for (int i = 1; i < end; i++) {
+                    libpd_sysex(port, data[i]);
+                }
+            }
+        } else if (status == 0xf8 || status == 0xfa || status == 0xfb || status == 0xfc || status == 0xfe || status == 0xff) {
+            if (receivers.realtimein) {
+                sendOffset();
+                libpd_sysrealtime(port, status);
+            }
+        }
+        break;
+    }
+
+    if (receivers.midiin) {
+        sendOffset();
+        for (int i = 0; i < size; i++) {
+            libpd_midibyte(port, data[i]);
+        }
+    }
+}
+
 void Instance::sendBang(char const* receiver) const
 {
     if (!ProjectInfo::isStandalone && !instance)
@@ -518,38 +636,6 @@ void Instance::unregisterMessageListener(void* object, MessageListener* messageL
     messageDispatcher->removeMessageListener(object, messageListener);
 }
 
-void Instance::registerWeakReference(void* ptr, pd_weak_reference* ref)
-{
-    weakReferenceMutex.lock();
-    pdWeakReferences[ptr].push_back(ref);
-    weakReferenceMutex.unlock();
-}
-
-void Instance::unregisterWeakReference(void* ptr, pd_weak_reference const* ref)
-{
-    weakReferenceMutex.lock();
-
-    auto& refs = pdWeakReferences[ptr];
-
-    auto it = std::find(refs.begin(), refs.end(), ref);
-
-    if (it != refs.end()) {
-        pdWeakReferences[ptr].erase(it);
-    }
-
-    weakReferenceMutex.unlock();
-}
-
-void Instance::clearWeakReferences(void* ptr)
-{
-    weakReferenceMutex.lock();
-    for (auto* ref : pdWeakReferences[ptr]) {
-        *ref = false;
-    }
-    pdWeakReferences.erase(ptr);
-    weakReferenceMutex.unlock();
-}
-
 void Instance::enqueueFunctionAsync(std::function<void(void)> const& fn)
 {
     functionQueue.enqueue(fn);
@@ -594,71 +680,82 @@ void Instance::handleAsyncUpdate()
 {
     Message mess;
     while (guiMessageQueue.try_dequeue(mess)) {
-        auto const dest = hash(mess.destination);
+        if (mess.overflow) {
+            handleGuiMessage(mess, *mess.overflow);
+            atomBufferPool.release(mess.overflow);
+        } else {
+            guiMessageAtoms.assign(mess.atoms, mess.atoms + mess.size);
+            handleGuiMessage(mess, guiMessageAtoms);
+        }
+    }
+}
 
-        switch (dest) {
-        case hash("pd"):
-            receiveSysMessage(mess.selector, mess.list);
-            break;
-        case hash("latency_compensation"):
-            if (mess.list.size() == 1) {
-                if (!mess.list[0].isFloat())
-                    return;
-                performLatencyCompensationChange(mess.list[0].getFloat());
-            }
-            break;
-        case hash("param"):
-            if (mess.list.size() >= 2) {
-                if (!mess.list[0].isSymbol() || !mess.list[1].isFloat())
-                    return;
-                auto name = mess.list[0].toString();
-                float value = mess.list[1].getFloat();
-                performParameterChange(0, name, value);
-            }
-            break;
-        case hash("param_create"):
-            if (mess.list.size() >= 1) {
-                if (!mess.list[0].isSymbol())
-                    return;
-                auto name = mess.list[0].toString();
-                enableAudioParameter(name);
-            }
-            break;
-        case hash("param_range"):
-            if (mess.list.size() >= 3) {
-                if (!mess.list[0].isSymbol() || !mess.list[1].isFloat() || !mess.list[2].isFloat())
-                    return;
-                auto name = mess.list[0].toString();
-                float min = mess.list[1].getFloat();
-                float max = mess.list[2].getFloat();
-                setParameterRange(name, min, max);
-            }
-            break;
-        case hash("param_mode"):
-            if (mess.list.size() >= 2) {
-                if (!mess.list[0].isSymbol() || !mess.list[1].isFloat())
-                    return;
-                auto name = mess.list[0].toString();
-                float mode = mess.list[1].getFloat();
-                setParameterMode(name, mode);
-            }
-            break;
-        case hash("param_change"):
-            if (mess.list.size() >= 2) {
-                if (!mess.list[0].isSymbol() || !mess.list[1].isFloat())
-                    return;
-                auto name = mess.list[0].toString();
-                int state = mess.list[1].getFloat() != 0;
-                performParameterChange(1, name, state);
-            }
-            break;
-            // JYG added this
-        case hash("to_daw_databuffer"):
-            fillDataBuffer(mess.list);
-            break;
-        default:
-            break;
+void Instance::handleGuiMessage(Message const& mess, std::vector<Atom> const& list)
+{
+    auto const dest = hash(mess.destination->s_name);
+
+    switch (dest) {
+    case hash("pd"):
+        receiveSysMessage(String::fromUTF8(mess.selector->s_name), list);
+        break;
+    case hash("latency_compensation"):
+        if (list.size() == 1) {
+            if (!list[0].isFloat())
+                return;
+            performLatencyCompensationChange(list[0].getFloat());
+        }
+        break;
+    case hash("param"):
+        if (list.size() >= 2) {
+            if (!list[0].isSymbol() || !list[1].isFloat())
+                return;
+            auto name = list[0].toString();
+            float value = list[1].getFloat();
+            performParameterChange(0, name, value);
+        }
+        break;
+    case hash("param_create"):
+        if (list.size() >= 1) {
+            if (!list[0].isSymbol())
+                return;
+            auto name = list[0].toString();
+            enableAudioParameter(name);
+        }
+        break;
+    case hash("param_range"):
+        if (list.size() >= 3) {
+            if (!list[0].isSymbol() || !list[1].isFloat() || !list[2].isFloat())
+                return;
+            auto name = list[0].toString();
+            float min = list[1].getFloat();
+            float max = list[2].getFloat();
+            setParameterRange(name, min, max);
+        }
+        break;
+    case hash("param_mode"):
+        if (list.size() >= 2) {
+            if (!list[0].isSymbol() || !list[1].isFloat())
+                return;
+            auto name = list[0].toString();
+            float mode = list[1].getFloat();
+            setParameterMode(name, mode);
         }
+        break;
+    case hash("param_change"):
+        if (list.size() >= 2) {
+            if (!list[0].isSymbol() || !list[1].isFloat())
+                return;
+            auto name = list[0].toString();
+            int state = list[1].getFloat() != 0;
+            performParameterChange(1, name, state);
+        }
+        break;
+        // JYG added this
+    case hash("to_daw_databuffer"):
+        fillDataBuffer(list);
+        break;
+    default:
+        break;
     }
 }
 
@@ -674,19 +771,77 @@ void Instance::sendMessagesFromQueue()
     sys_unlock();
 }
 
-Patch::Ptr Instance::openPatch(File const& toOpen)
+Patch::Ptr Instance::openPatch(File const& toOpen, bool const useCache)
 {
+    if (useCache && PatchCache::canCache(toOpen)) {
+        auto prepared = preparePatches({ { String(), toOpen, true } });
+
+        lockAudioThread();
+        auto patch = openPatch(prepared.front());
+        unlockAudioThread();
+
+        return patch;
+    }
+
     String dirname = toOpen.getParentDirectory().getFullPathName().replace("\\", "/");
     auto const* dir = dirname.toRawUTF8();
 
     String filename = toOpen.getFileName();
     auto const* file = filename.toRawUTF8();
 
+    lockAudioThread();
     setThis();
 
     auto* cnv = static_cast<t_canvas*>(pd::Interface::createCanvas(file, dir));
+    Patch::Ptr patch = new Patch(pd::WeakReference(cnv, this), this, true, toOpen);
+    unlockAudioThread();
+
+    return patch;
+}
+
+std::vector<PatchLoader::PreparedPatch> Instance::preparePatches(std::vector<PatchLoader::Source> const& sources)
+{
+    auto prepared = PatchLoader::prepare(sources);
+
+    // Tokenising creates pd symbols, so it needs the lock, but audio can keep running in between patches
+    for (auto& patch : prepared) {
+        if (!patch.isValid || patch.hasCachedContent)
+            continue;
+
+        lockAudioThread();
+        setThis();
+        PatchLoader::tokenise(patch);
+        unlockAudioThread();
+
+        PatchLoader::writeCache(patch);
+    }
+
+    return prepared;
+}
+
+Patch::Ptr Instance::openPatch(PatchLoader::PreparedPatch const& prepared)
+{
+    // Untitled patches get a location in the temp directory, like patches that are loaded from a temporary file
+    auto location = prepared.location;
+    if (location.getFullPathName().isEmpty() || !location.getParentDirectory().exists())
+        location = File::getSpecialLocation(File::tempDirectory).getChildFile("Untitled.pd");
+
+    String dirname = location.getParentDirectory().getFullPathName().replace("\\", "/");
+    String filename = location.getFileName();
+
+    setThis();
 
-    return new Patch(pd::WeakReference(cnv, this), this, true, toOpen);
+    t_canvas* cnv = nullptr;
+    if (prepared.isValid) {
+        auto* content = binbuf_new();
+        PatchLoader::addToBinbuf(prepared, content);
+        cnv = pd::Interface::createCanvasFromBinbuf(content, filename.toRawUTF8(), dirname.toRawUTF8());
+        binbuf_free(content);
+    } else {
+        pd_error(nullptr, "%s: can't open", filename.toRawUTF8());
+    }
+
+    return new Patch(pd::WeakReference(cnv, this), this, true, location);
 }
 
 void Instance::setThis() const
@@ -730,84 +885,29 @@ std::deque<std::tuple<void*, String, int, int, int>>& Instance::getConsoleHistor
     return consoleHandler.consoleHistory;
 }
 
-void Instance::createPanel(int type, char const* snd, char const* location, char const* callbackName, int openMode)
+NamedValueSet Instance::getMemoryUsage()
 {
-    auto* obj = generateSymbol(snd)->s_thing;
-
-    auto defaultFile = File(location);
-    if (!defaultFile.exists()) {
-        defaultFile = SettingsFile::getInstance()->getLastBrowserPathForId("openpanel");
-        if (!defaultFile.exists())
-            defaultFile = ProjectInfo::appDataDir;
-    }
-
-    if (type) {
-        MessageManager::callAsync(
-            [this, obj, defaultFile, openMode, callback = String(callbackName)]() mutable {
-                FileBrowserComponent::FileChooserFlags folderChooserFlags;
-
-                if (openMode <= 0) {
-                    folderChooserFlags = static_cast<FileBrowserComponent::FileChooserFlags>(FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles);
-                } else if (openMode == 1) {
-                    folderChooserFlags = static_cast<FileBrowserComponent::FileChooserFlags>(FileBrowserComponent::openMode | FileBrowserComponent::canSelectDirectories);
-                } else {
-                    folderChooserFlags = static_cast<FileBrowserComponent::FileChooserFlags>(FileBrowserComponent::openMode | FileBrowserComponent::canSelectDirectories | FileBrowserComponent::canSelectFiles | FileBrowserComponent::canSelectMultipleItems);
-                }
+    NamedValueSet usage;
 
-                static std::unique_ptr<FileChooser> openChooser;
-                openChooser = std::make_unique<FileChooser>("Open...", defaultFile, "", SettingsFile::getInstance()->wantsNativeDialog());
-                openChooser->launchAsync(folderChooserFlags, [this, obj, callback](FileChooser const& fileChooser) {
-                    auto const files = fileChooser.getResults();
-                    if (files.isEmpty())
-                        return;
+    usage.set("message_dispatcher", static_cast<int64>(messageDispatcher->getMemoryUsage()));
 
-                    auto parentDirectory = files.getFirst().getParentDirectory();
-                    SettingsFile::getInstance()->setLastBrowserPathForId("openpanel", parentDirectory);
-
-                    lockAudioThread();
-
-                    std::vector<t_atom> atoms(files.size());
-
-                    for (int i = 0; i < atoms.size(); i++) {
-                        String pathname = files[i].getFullPathName();
-
-                    // Convert slashes to backslashes
-#if JUCE_WINDOWS
-                        pathname = pathname.replaceCharacter('\\', '/');
-#endif
+    size_t consoleMemory = 0;
+    for (auto* messages : { &consoleHandler.consoleMessages, &consoleHandler.consoleHistory }) {
+        for (auto& [object, message, type, length, repeats] : *messages) {
+            consoleMemory += sizeof(std::tuple<void*, String, int, int, int>) + message.getNumBytesAsUTF8();
+        }
+    }
+    usage.set("console", static_cast<int64>(consoleMemory));
 
-                        libpd_set_symbol(atoms.data() + i, pathname.toRawUTF8());
-                    }
+    usage.set("weak_references", static_cast<int64>(weakReferences.getMemoryUsage()));
 
-                    pd_typedmess(obj, generateSymbol(callback), atoms.size(), atoms.data());
+    return usage;
+}
 
-                    unlockAudioThread();
-                });
-            });
-    } else {
-        MessageManager::callAsync(
-            [this, obj, defaultFile, callback = String(callbackName)]() mutable {
-
-#if JUCE_IOS
-                Component* dialogParent = dynamic_cast<AudioProcessor*>(this)->getActiveEditor();
-#else
-                Component* dialogParent = nullptr;
-#endif
-
-                Dialogs::showSaveDialog([this, obj, callback](URL result) {
-                    auto pathName = result.getLocalFile().getFullPathName();
-                    const auto* path = pathName.toRawUTF8();
-
-                    t_atom argv[1];
-                    libpd_set_symbol(argv, path);
-
-                    lockAudioThread();
-                    pd_typedmess(obj, generateSymbol(callback), 1, argv);
-                    unlockAudioThread();
-                },
-                    "", "openpanel", dialogParent);
-            });
-    }
+void Instance::createPanel(int type, char const* snd, char const* location, char const* callbackName, int openMode)
+{
+    // File dialogs need a GUI runtime, the plugin processor overrides this to show them
+    logWarning(String(type ? "openpanel" : "savepanel") + ": file dialogs are not available in this instance");
 }
 
 bool Instance::loadLibrary(String const& libraryToLoad)
@@ -815,35 +915,52 @@ bool Instance::loadLibrary(String const& libraryToLoad)
     return sys_load_lib(nullptr, libraryToLoad.toRawUTF8());
 }
 
-void Instance::lockAudioThread()
+void Instance::lockAudioThread(std::source_location const& location)
 {
     audioLock.enter();
+    lockTelemetry.lockAcquired(location);
 }
 
-bool Instance::tryLockAudioThread()
+bool Instance::tryLockAudioThread(std::source_location const& location)
 {
     if (audioLock.tryEnter()) {
+        lockTelemetry.lockAcquired(location);
         return true;
     }
 
     return false;
 }
 
-void Instance::unlockAudioThread()
+bool Instance::tryLockAudioThread(double const timeoutMs)
 {
-    audioLock.exit();
-}
+    if (audioLock.tryEnter())
+        return true;
 
-void Instance::updateObjectImplementations()
-{
-    objectImplementations->updateObjectImplementations();
+    // Sleep until the lock is released or the deadline passes, instead of spinning
+    // The flag is set before trying again, so a release in between always signals us
+    auto const deadline = Time::getMillisecondCounterHiRes() + timeoutMs;
+    audioLockWaiting = true;
+
+    auto locked = false;
+    while (!(locked = audioLock.tryEnter())) {
+        auto const remaining = deadline - Time::getMillisecondCounterHiRes();
+        if (remaining <= 0.0)
+            break;
+
+        audioLockReleased.wait(remaining);
+    }
+
+    audioLockWaiting = false;
+    return locked;
 }
 
-void Instance::clearObjectImplementationsForPatch(pd::Patch* p)
+void Instance::unlockAudioThread()
 {
-    if (auto patch = p->getPointer()) {
-        objectImplementations->clearObjectImplementationsForPatch(patch.get());
-    }
+    lockTelemetry.lockReleased();
+    audioLock.exit();
+
+    if (audioLockWaiting)
+        audioLockReleased.signal();
 }
 
 void Instance::registerLuaClass(char const* className)
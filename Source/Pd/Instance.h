@@ -14,9 +14,10 @@ extern "C" {
 #include <concurrentqueue.h>
 #include <readerwriterqueue.h>
 #include "Utility/CachedStringWidth.h"
+#include "Utility/LockTelemetry.h"
 #include "Patch.h"
-
-class ObjectImplementationManager;
+#include "PatchLoader.h"
+#include "PatchWriter.h"
 
 namespace pd {
 
@@ -131,14 +132,47 @@ private:
     t_symbol* symbol;
 };
 
+// Buffers for atom lists that are too long to be stored inside an Instance::Message
+// Buffers are taken by the receive hooks and given back once the message has been handled. They keep their capacity,
+// so once the pool has warmed up, even long lists can be passed to the message thread without allocating
+class AtomBufferPool {
+public:
+    // Only called from pd's receive hooks, so it is serialised by the pd lock
+    std::vector<Atom>* acquire(int size)
+    {
+        std::vector<Atom>* buffer = nullptr;
+        if (!freeBuffers.try_dequeue(buffer)) {
+            buffer = &buffers.emplace_back();
+        }
+
+        buffer->resize(size);
+        return buffer;
+    }
+
+    void release(std::vector<Atom>* buffer)
+    {
+        freeBuffers.enqueue(buffer);
+    }
+
+private:
+    std::deque<std::vector<Atom>> buffers; // deque, so buffers don't move when it grows
+    moodycamel::ConcurrentQueue<std::vector<Atom>*> freeBuffers;
+};
+
 class MessageListener;
 class MessageDispatcher;
 class Patch;
 class Instance : public AsyncUpdater {
+    // Message from pd to one of plugdata's receivers, these are created on the audio thread
+    // The selector and destination are kept as pd symbols, and short lists are stored inline, so creating one doesn't allocate
     struct Message {
-        String selector;
-        String destination;
-        std::vector<pd::Atom> list;
+        static constexpr int maxInlineAtoms = 8;
+
+        t_symbol* selector = nullptr;
+        t_symbol* destination = nullptr;
+        int size = 0;
+        Atom atoms[maxInlineAtoms];
+        std::vector<Atom>* overflow = nullptr; // Borrowed from the AtomBufferPool when the list doesn't fit in atoms
     };
 
     struct dmessage {
@@ -181,6 +215,23 @@ public:
     void sendSysRealTime(int port, int byte) const;
     void sendMidiByte(int port, int byte) const;
 
+    // Which of pd's MIDI receivers have objects bound to them
+    // Checked once per block, so we don't have to feed pd events that nothing listens to
+    struct MidiReceivers {
+        bool notein = false, ctlin = false, pgmin = false, bendin = false, touchin = false, polytouchin = false;
+        bool sysexin = false, realtimein = false, midiin = false, offset = false;
+
+        bool any() const { return notein || ctlin || pgmin || bendin || touchin || polytouchin || sysexin || realtimein || midiin; }
+    };
+
+    // Both need to be called with this instance set
+    MidiReceivers getMidiReceivers() const;
+
+    // Decodes a raw MIDI message once and sends it to the receivers that exist
+    // If something listens to "midi_offset", it receives the position of the event within the pd block in ms, which can be used as a vline~ delay
+    // The offset is only sent for events that are passed on to pd, right before the first receiver gets them
+    void sendMidiEvent(MidiReceivers const& receivers, uint8 const* data, int size, int port, int sampleOffset) const;
+
     virtual void receiveNoteOn(int channel, int pitch, int velocity) = 0;
     virtual void receiveControlChange(int channel, int controller, int value) = 0;
     virtual void receiveProgramChange(int channel, int value) = 0;
@@ -206,10 +257,6 @@ public:
     void registerMessageListener(void* object, MessageListener* messageListener);
     void unregisterMessageListener(void* object, MessageListener* messageListener);
 
-    void registerWeakReference(void* ptr, pd_weak_reference* ref);
-    void unregisterWeakReference(void* ptr, pd_weak_reference const* ref);
-    void clearWeakReferences(void* ptr);
-
     static void registerLuaClass(char const* object);
     bool isLuaClass(hash32 objectNameHash);
 
@@ -238,8 +285,9 @@ public:
     void sendDirectMessage(void* object, String const& msg);
     void sendDirectMessage(void* object, float msg);
 
-    void updateObjectImplementations();
-    void clearObjectImplementationsForPatch(pd::Patch* p);
+    // Object implementations are GUI-side helpers, so only the plugin processor provides them
+    virtual void updateObjectImplementations() { }
+    virtual void clearObjectImplementationsForPatch(pd::Patch* p) { }
 
     virtual void performParameterChange(int type, String const& name, float value) = 0;
     virtual void enableAudioParameter(String const& name) = 0;
@@ -259,10 +307,23 @@ public:
     std::deque<std::tuple<void*, String, int, int, int>>& getConsoleMessages();
     std::deque<std::tuple<void*, String, int, int, int>>& getConsoleHistory();
 
+    // Approximate memory used by this instance in bytes, broken down by subsystem
+    // This is a partial report: it only covers plugdata's own buffers and caches, not memory allocated by pd, JUCE or the editor
+    virtual NamedValueSet getMemoryUsage();
+
     void sendMessagesFromQueue();
     void processSend(dmessage mess);
 
-    Patch::Ptr openPatch(File const& toOpen);
+    // When useCache is true, the patch is read through a binary .pdc sidecar file (see PatchCache)
+    // This takes the audio lock itself, so the patch file and cache can be read and written without holding it
+    Patch::Ptr openPatch(File const& toOpen, bool useCache = false);
+
+    // Reads patches and decodes or writes their caches for openPatch(PreparedPatch), see PatchLoader
+    // Call this without holding the audio lock, it only takes it briefly for each patch that has to be tokenised
+    std::vector<PatchLoader::PreparedPatch> preparePatches(std::vector<PatchLoader::Source> const& sources);
+
+    // Opens a patch that was already read by preparePatches()
+    Patch::Ptr openPatch(PatchLoader::PreparedPatch const& prepared);
 
     virtual void reloadAbstractions(File changedPatch, t_glist* except) = 0;
 
@@ -270,10 +331,17 @@ public:
     t_symbol* generateSymbol(String const& symbol) const;
     t_symbol* generateSymbol(char const* symbol) const;
 
-    void lockAudioThread();
-    bool tryLockAudioThread();
+    // The location is only used for lock telemetry
+    void lockAudioThread(std::source_location const& location = std::source_location::current());
+    bool tryLockAudioThread(std::source_location const& location = std::source_location::current());
     void unlockAudioThread();
 
+    // Waits for the lock until the timeout has passed, for the audio thread in contention-aware mode
+    // Only releases through unlockAudioThread() wake it up early, so anything that holds the lock should go through that
+    bool tryLockAudioThread(double timeoutMs);
+
+    LockTelemetry lockTelemetry;
+
     bool loadLibrary(String const& library);
 
     void* instance = nullptr;
@@ -288,30 +356,55 @@ public:
     void* printReceiver = nullptr;
     void* dataBufferReceiver = nullptr;
 
+    // Pd's internal MIDI receivers, see getMidiReceivers()
+    enum MidiReceiverSymbol {
+        NoteIn = 0,
+        CtlIn,
+        PgmIn,
+        BendIn,
+        TouchIn,
+        PolyTouchIn,
+        SysexIn,
+        RealtimeIn,
+        MidiIn,
+        MidiOffset,
+        NumMidiReceiverSymbols
+    };
+    std::array<t_symbol*, NumMidiReceiverSymbols> midiReceiverSymbols = {};
+
     inline static String const defaultPatch = "#N canvas 827 239 527 327 12;";
 
     bool isPerformingGlobalSync = false;
     CriticalSection const audioLock;
-    std::recursive_mutex weakReferenceMutex;
+
+    // Used by tryLockAudioThread(timeoutMs) to wait for unlockAudioThread()
+    std::atomic<bool> audioLockWaiting = false;
+    WaitableEvent audioLockReleased;
+    WeakReferenceRegistry weakReferences;
     std::unique_ptr<pd::MessageDispatcher> messageDispatcher;
 
     // All opened patches
     Array<pd::Patch::Ptr, CriticalSection> patches;
 
+    // Writes saved patches to disk, so the pd lock is never held during file IO
+    // Can be replaced while nothing is being saved, for example with a writer that simulates a slow disk
+    std::unique_ptr<PatchWriter> patchWriter = std::make_unique<PatchWriter>();
+
 private:
-    std::unordered_map<void*, std::vector<pd_weak_reference*>> pdWeakReferences;
 
-    moodycamel::ConcurrentQueue<std::function<void(void)>> functionQueue = moodycamel::ConcurrentQueue<std::function<void(void)>>(4096);
+    // Only needs to hold the callbacks for one audio block, it will grow if that's not enough
+    moodycamel::ConcurrentQueue<std::function<void(void)>> functionQueue = moodycamel::ConcurrentQueue<std::function<void(void)>>(256);
     moodycamel::ConcurrentQueue<Message> guiMessageQueue = moodycamel::ConcurrentQueue<Message>(64);
+    AtomBufferPool atomBufferPool;
+    std::vector<Atom> guiMessageAtoms; // Reused for every message that fits inline, only used on the message thread
+
+    void handleGuiMessage(Message const& message, std::vector<Atom> const& list);
 
-    std::unique_ptr<FileChooser> openChooser;
     static inline std::set<hash32> luaClasses = std::set<hash32>(); // Keep track of class names that correspond to pdlua objects
 
 protected:
     struct internal;
 
-    std::unique_ptr<ObjectImplementationManager> objectImplementations;
-
     struct ConsoleHandler : public AsyncUpdater {
         Instance* instance;
 
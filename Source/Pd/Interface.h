@@ -23,6 +23,8 @@ extern void canvas_doclick(t_canvas *x, int xpos, int ypos, int which, int mod,
 extern void canvas_doconnect(t_canvas *x, int xpos, int ypos, int mod, int doit);
 extern void set_class_prefix(t_symbol*);
 extern void clear_class_loadsym();
+extern void glob_setfilename(void* dummy, t_symbol* name, t_symbol* dir);
+extern void pd_doloadbang(void);
 
 }
 
@@ -39,6 +41,55 @@ struct Interface {
         return cnv;
     }
 
+    // Same as createCanvas, but evaluates an already parsed patch instead of reading it from disk
+    // This is glob_evalfile and binbuf_evalfile from Pd combined, without the file reading
+    static t_canvas* createCanvasFromBinbuf(t_binbuf* content, char const* name, char const* path)
+    {
+        auto const dspState = canvas_suspend_dsp();
+
+        // Don't restore #X, we'll need it to grab the new canvas
+        auto* boundX = s__X.s_thing;
+        s__X.s_thing = nullptr;
+
+        glob_setfilename(nullptr, gensym(name), gensym(path));
+
+        // Save the bindings of #N and #A, and restore them afterwards
+        auto* boundA = gensym("#A")->s_thing;
+        auto* boundN = s__N.s_thing;
+        gensym("#A")->s_thing = nullptr;
+        s__N.s_thing = &pd_canvasmaker;
+
+        binbuf_eval(content, nullptr, 0, nullptr);
+
+        // Avoid crashing if no canvas was created by the patch
+        if (s__X.s_thing && *s__X.s_thing == canvas_class)
+            canvas_initbang(reinterpret_cast<t_canvas*>(s__X.s_thing));
+
+        gensym("#A")->s_thing = boundA;
+        s__N.s_thing = boundN;
+
+        glob_setfilename(nullptr, &s_, &s_);
+
+        t_pd* x = nullptr;
+        t_canvas* cnv = nullptr;
+        while ((x != s__X.s_thing) && s__X.s_thing) {
+            x = s__X.s_thing;
+            cnv = reinterpret_cast<t_canvas*>(x);
+            vmess(x, gensym("pop"), "i", 1);
+        }
+
+        if (!sys_noloadbang)
+            pd_doloadbang();
+
+        canvas_resume_dsp(dspState);
+        s__X.s_thing = boundX;
+
+        if (cnv) {
+            canvas_vis(cnv, 1.f);
+        }
+        return cnv;
+    }
+
     static char const* getObjectClassName(t_pd* ptr)
     {
         return class_getname(pd_class(ptr));
@@ -504,6 +555,7 @@ struct Interface {
 
     /* save a "root" canvas to a file; cf. canvas_saveto() which saves the
      body (and which is called recursively.) */
+    // Used for Max patches, which binbuf_write() converts while writing
     static void saveToFile(t_canvas* cnv, t_symbol* filename, t_symbol* dir)
     {
         t_binbuf* b = binbuf_new();
@@ -514,18 +566,92 @@ struct Interface {
             post("%s/%s: %s", dir->s_name, filename->s_name,
                 (errno ? strerror(errno) : "write failed"));
         else {
-            /* if not an abstraction, reset title bar and directory */
-            if (!cnv->gl_owner) {
-                canvas_rename(cnv, filename, dir);
-                /* update window list in case Save As changed the window name */
-                canvas_updatewindowlist();
-            }
+            setSaved(cnv, filename, dir);
             post("saved to: %s/%s", dir->s_name, filename->s_name);
-            canvas_dirty(cnv, 0);
         }
         binbuf_free(b);
     }
 
+    // Serialises a patch to text formatted like binbuf_write() would, but without touching the disk
+    // This doesn't change the canvas: call setSaved() once the result was actually written to filename
+    static std::string saveToMemory(t_canvas* cnv)
+    {
+        t_binbuf* b = binbuf_new();
+        canvas_savetemplatesto(cnv, b, 1);
+        canvas_saveto(cnv, b);
+
+        std::string result;
+        std::vector<char> atomText(MAXPDSTRING);
+        int numColumns = 0;
+
+        auto const numAtoms = binbuf_getnatom(b);
+        auto const* atoms = binbuf_getvec(b);
+        for (int i = 0; i < numAtoms; i++) {
+            auto const& atom = atoms[i];
+            if ((atom.a_type == A_SEMI || atom.a_type == A_COMMA) && !result.empty() && result.back() == ' ')
+                result.pop_back();
+
+            // atom_string() truncates to the buffer size, and escaping can at most double the length of a symbol
+            if (atom.a_type == A_SYMBOL || atom.a_type == A_DOLLSYM) {
+                auto const requiredSize = strlen(atom.a_w.w_symbol->s_name) * 2 + 3;
+                if (requiredSize > atomText.size())
+                    atomText.resize(requiredSize);
+            }
+
+            atom_string(&atom, atomText.data(), static_cast<unsigned int>(atomText.size()));
+            auto const length = static_cast<int>(strlen(atomText.data()));
+            result.append(atomText.data(), length);
+            numColumns += length;
+
+            if (atom.a_type == A_SEMI || numColumns > 65) {
+                result.push_back('\n');
+                numColumns = 0;
+            } else {
+                result.push_back(' ');
+                numColumns++;
+            }
+        }
+        binbuf_free(b);
+
+        return result;
+    }
+
+    // Marks a canvas as saved to filename in dir
+    // Pass isUpToDate = false if the patch was edited after it was serialised, so it stays dirty
+    static void setSaved(t_canvas* cnv, t_symbol* filename, t_symbol* dir, bool isUpToDate = true)
+    {
+        /* if not an abstraction, reset title bar and directory */
+        if (!cnv->gl_owner) {
+            canvas_rename(cnv, filename, dir);
+            /* update window list in case Save As changed the window name */
+            canvas_updatewindowlist();
+        }
+        if (isUpToDate)
+            canvas_dirty(cnv, 0);
+    }
+
+    // Returns true if a patch file is opened, or used as an abstraction, anywhere other than in except
+    static bool isPatchInstantiated(t_symbol* filename, t_symbol* dir, t_glist* except)
+    {
+        for (t_glist* root = pd_getcanvaslist(); root; root = root->gl_next) {
+            if (isPatchInstantiated(root, filename, dir, except))
+                return true;
+        }
+        return false;
+    }
+
+    static bool isPatchInstantiated(t_glist* cnv, t_symbol* filename, t_symbol* dir, t_glist* except)
+    {
+        if (cnv != except && cnv->gl_name == filename && (!cnv->gl_owner || canvas_isabstraction(cnv)) && canvas_getdir(cnv) == dir)
+            return true;
+
+        for (t_gobj* y = cnv->gl_list; y; y = y->g_next) {
+            if (pd_class(&y->g_pd) == canvas_class && isPatchInstantiated(reinterpret_cast<t_glist*>(y), filename, dir, except))
+                return true;
+        }
+        return false;
+    }
+
     static t_gobj* createObject(t_canvas* cnv, t_symbol* s, int argc, t_atom* argv)
     {
         canvas_setcurrent(cnv);
@@ -617,6 +743,14 @@ struct Interface {
         canvas_dirty(cnv, 1);
     }
 
+    // Every undoable edit moves this, so it tells whether a patch was edited since it was last looked at
+    // pd can reuse the memory of an undone action for the next one, so an unchanged position doesn't prove there were no edits
+    static void const* getUndoPosition(t_canvas* cnv)
+    {
+        auto* undo = canvas_undo_get(cnv);
+        return undo ? undo->u_last : nullptr;
+    }
+
     static int getUndoSize(t_canvas* cnv)
     {
         auto* undo = canvas_undo_get(cnv)->u_queue;
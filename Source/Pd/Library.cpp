@@ -6,14 +6,16 @@
 
 #include <juce_data_structures/juce_data_structures.h>
 #include <juce_events/juce_events.h>
-#include <juce_gui_basics/juce_gui_basics.h>
 
 #include "Utility/Config.h"
 
 #include <BinaryData.h>
 
 #include "Utility/OSUtils.h"
-#include "Utility/SettingsFile.h"
+
+#if !PLUGDATA_HEADLESS
+#    include "Utility/SettingsFile.h"
+#endif
 
 extern "C" {
 #include <m_pd.h>
@@ -43,6 +45,11 @@ Library::Library(pd::Instance* instance) : Thread("Library Index Thread"), pd(in
     watcher.addFolder(ProjectInfo::appDataDir);
     watcher.addListener(this);
 
+#if PLUGDATA_HEADLESS
+    // There is no message loop to defer to, and no plugin validation to worry about
+    pd->setThis();
+    updateLibrary();
+#else
     // Needs to be async, otherwise LV2 validation fails
     MessageManager::callAsync([this, pd = juce::WeakReference(pd)]() {
         if (pd.get()) {
@@ -50,6 +57,7 @@ Library::Library(pd::Instance* instance) : Thread("Library Index Thread"), pd(in
             updateLibrary();
         }
     });
+#endif
 
     startThread();
 }
@@ -184,6 +192,7 @@ void Library::run()
         }
     }
     
+    documentationIndexed = true;
     initWait.signal();
 }
 
@@ -272,29 +281,67 @@ ValueTree Library::getObjectInfo(String const& name)
     return documentationIndex[hash(name)];
 }
 
-std::array<StringArray, 2> Library::parseIoletTooltips(ValueTree const& iolets, String const& name, int numIn, int numOut)
+Library::ObjectDocumentation Library::getObjectDocumentation(String const& type)
 {
-    std::array<StringArray, 2> result;
-    Array<std::pair<String, bool>> inlets;
-    Array<std::pair<String, bool>> outlets;
+    // Still being indexed, don't cache anything yet
+    if (!documentationIndexed)
+        return {};
 
-    auto args = StringArray::fromTokens(name.fromFirstOccurrenceOf(" ", false, false), true);
+    std::lock_guard<std::recursive_mutex> lock(libraryLock);
+
+    auto const key = hash(type);
+    if (auto it = documentationCache.find(key); it != documentationCache.end())
+        return it->second;
+
+    ObjectDocumentation documentation;
+    if (auto it = documentationIndex.find(key); it != documentationIndex.end() && it->second.isValid()) {
+        auto const& objectInfo = it->second;
+        documentation.description = objectInfo.getProperty("description").toString();
+
+        for (auto iolet : objectInfo.getChildWithName("iolets")) {
+            auto isVariable = iolet.getProperty("variable").toString() == "1";
+            auto tooltip = iolet.getProperty("tooltip").toString();
+            if (iolet.getType() == Identifier("inlet")) {
+                documentation.iolets[0].add({ tooltip, isVariable });
+            }
+
+            if (iolet.getType() == Identifier("outlet")) {
+                documentation.iolets[1].add({ tooltip, isVariable });
+            }
+        }
+    }
+
+    return documentationCache[key] = documentation;
+}
+
+std::array<StringArray, 2> Library::parseIoletTooltips(ValueTree const& iolets, String const& name, int numIn, int numOut)
+{
+    ObjectDocumentation documentation;
 
     for (auto iolet : iolets) {
         auto isVariable = iolet.getProperty("variable").toString() == "1";
         auto tooltip = iolet.getProperty("tooltip");
         if (iolet.getType() == Identifier("inlet")) {
-            inlets.add({ tooltip, isVariable });
+            documentation.iolets[0].add({ tooltip, isVariable });
         }
 
         if (iolet.getType() == Identifier("outlet")) {
-            outlets.add({ tooltip, isVariable });
+            documentation.iolets[1].add({ tooltip, isVariable });
         }
     }
 
+    return parseIoletTooltips(documentation, name, numIn, numOut);
+}
+
+std::array<StringArray, 2> Library::parseIoletTooltips(ObjectDocumentation const& documentation, String const& name, int numIn, int numOut)
+{
+    std::array<StringArray, 2> result;
+
+    auto args = StringArray::fromTokens(name.fromFirstOccurrenceOf(" ", false, false), true);
+
     for (int type = 0; type < 2; type++) {
         int total = type ? numOut : numIn;
-        auto& descriptions = type ? outlets : inlets;
+        auto& descriptions = documentation.iolets[type];
         // if the amount of inlets is not equal to the amount in the spec, look for repeating iolets
         if (descriptions.size() < total) {
             for (int i = 0; i < descriptions.size(); i++) {
@@ -325,6 +372,21 @@ std::array<StringArray, 2> Library::parseIoletTooltips(ValueTree const& iolets,
     return result;
 }
 
+std::array<StringArray, 2> Library::getAbstractionIoletComments(File const& patchFile, std::function<std::array<StringArray, 2>()> const& parseComments)
+{
+    std::lock_guard<std::recursive_mutex> lock(libraryLock);
+
+    auto const key = hash(patchFile.getFullPathName());
+    auto const lastModified = patchFile.getLastModificationTime();
+
+    if (auto it = abstractionCommentCache.find(key); it != abstractionCommentCache.end() && it->second.lastModified == lastModified)
+        return it->second.comments;
+
+    auto comments = parseComments();
+    abstractionCommentCache[key] = { lastModified, comments };
+    return comments;
+}
+
 StringArray Library::getAllObjects()
 {
     return allObjects;
@@ -332,12 +394,90 @@ StringArray Library::getAllObjects()
 
 void Library::filesystemChanged()
 {
+    {
+        std::lock_guard<std::recursive_mutex> lock(libraryLock);
+        abstractionCommentCache.clear();
+#if PLUGDATA_HEADLESS
+        searchPathsLoaded = false;
+#endif
+    }
+
     updateLibrary();
 }
 
+#if PLUGDATA_HEADLESS
+ValueTree Library::getSearchPaths()
+{
+    // Without a SettingsFile, parse .settings once and re-read it only when it changes on disk
+    auto settingsFile = ProjectInfo::appDataDir.getChildFile(".settings");
+    auto lastModified = settingsFile.getLastModificationTime();
+
+    std::lock_guard<std::recursive_mutex> lock(libraryLock);
+    if (!searchPathsLoaded || lastModified != searchPathsModified) {
+        searchPathsCache = ValueTree::fromXml(settingsFile.loadFileAsString()).getChildWithName("Paths");
+        searchPathsModified = lastModified;
+        searchPathsLoaded = true;
+    }
+
+    return searchPathsCache;
+}
+#endif
+
+static size_t getValueTreeMemory(ValueTree const& tree)
+{
+    size_t memory = sizeof(ValueTree) + tree.getNumProperties() * sizeof(NamedValueSet::NamedValue);
+    for (int i = 0; i < tree.getNumProperties(); i++) {
+        memory += tree.getProperty(tree.getPropertyName(i)).toString().getNumBytesAsUTF8();
+    }
+    for (auto child : tree) {
+        memory += getValueTreeMemory(child);
+    }
+    return memory;
+}
+
+size_t Library::getMemoryUsage()
+{
+    std::lock_guard<std::recursive_mutex> lock(libraryLock);
+
+    size_t memory = 0;
+    for (auto* objects : { &allObjects, &gemObjects }) {
+        for (auto const& name : *objects) {
+            memory += sizeof(String) + name.getNumBytesAsUTF8();
+        }
+    }
+
+    for (auto const& [hash, documentation] : documentationIndex) {
+        memory += sizeof(hash) + getValueTreeMemory(documentation);
+    }
+
+    for (auto const& [hash, documentation] : documentationCache) {
+        memory += sizeof(hash) + sizeof(ObjectDocumentation) + documentation.description.getNumBytesAsUTF8();
+        for (auto const& iolets : documentation.iolets) {
+            for (auto const& [tooltip, repeats] : iolets) {
+                memory += sizeof(std::pair<String, bool>) + tooltip.getNumBytesAsUTF8();
+            }
+        }
+    }
+
+    for (auto const& [hash, abstraction] : abstractionCommentCache) {
+        memory += sizeof(hash) + sizeof(AbstractionComments);
+        for (auto const& comments : abstraction.comments) {
+            for (auto const& comment : comments) {
+                memory += sizeof(String) + comment.getNumBytesAsUTF8();
+            }
+        }
+    }
+
+    return memory;
+}
+
 File Library::findPatch(String const& patchToFind)
 {
+#if PLUGDATA_HEADLESS
+    auto pathTree = getSearchPaths();
+#else
     auto pathTree = SettingsFile::getInstance()->getValueTree().getChildWithName("Paths");
+#endif
     for (auto path : pathTree) {
         auto searchPath = File(path.getProperty("Path").toString());
         if (!searchPath.exists() || !searchPath.isDirectory())
@@ -35,10 +35,29 @@ public:
     
     static File findPatch(String const& patchToFind);
 
+    // Description and iolet tooltips of an object class, parsed from the documentation only once per class
+    struct ObjectDocumentation {
+        String description;
+        std::array<Array<std::pair<String, bool>>, 2> iolets; // Tooltip and whether it repeats, for inlets and outlets
+    };
+
+    ObjectDocumentation getObjectDocumentation(String const& type);
+
+    // Until this is true, getObjectDocumentation() returns empty documentation
+    bool isDocumentationIndexed() const { return documentationIndexed; }
+
     static std::array<StringArray, 2> parseIoletTooltips(ValueTree const& iolets, String const& name, int numIn, int numOut);
+    static std::array<StringArray, 2> parseIoletTooltips(ObjectDocumentation const& documentation, String const& name, int numIn, int numOut);
+
+    // Inlet and outlet comments of an abstraction, sorted by position
+    // Only parsed once per file, until the file is modified or the file watcher reports a change
+    std::array<StringArray, 2> getAbstractionIoletComments(File const& patchFile, std::function<std::array<StringArray, 2>()> const& parseComments);
 
     void filesystemChanged() override;
 
+    // Approximate number of bytes used by the object list, documentation index and tooltip caches
+    size_t getMemoryUsage();
+
     static File findHelpfile(t_gobj* obj, File const& parentPatchFile);
 
     ValueTree getObjectInfo(String const& name);
@@ -90,7 +109,24 @@ private:
     pd::Instance* pd;
 
     std::unordered_map<hash32, ValueTree> documentationIndex;
+
+    struct AbstractionComments {
+        Time lastModified;
+        std::array<StringArray, 2> comments;
+    };
+
+    std::unordered_map<hash32, ObjectDocumentation> documentationCache;
+    std::unordered_map<hash32, AbstractionComments> abstractionCommentCache;
     bool isInitialised = false;
+    std::atomic<bool> documentationIndexed = false;
+
+#if PLUGDATA_HEADLESS
+    ValueTree getSearchPaths();
+
+    ValueTree searchPathsCache;
+    Time searchPathsModified;
+    bool searchPathsLoaded = false;
+#endif
 };
 
 } // namespace pd
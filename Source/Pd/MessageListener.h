@@ -20,7 +20,9 @@ public:
 
 // MessageDispatcher handles the organising of messages from Pd to the plugdata GUI
 // It provides an optimised way to listen to messages within pd from the message thread,
-// without performing and memory allocation on the audio thread, and which groups messages within the same audio block (or multiple audio blocks, depending on how long it takes to get a callback from the message thread) togethter
+// and which groups messages within the same audio block (or multiple audio blocks, depending on how long it takes to get a callback from the message thread) togethter
+// The audio thread never allocates: the stacks start small, and the message thread grows them once a block gets close to filling one
+// Messages that don't fit anymore go to a preallocated backup queue, and are handled first because they're the newest
 class MessageDispatcher {
     // Wrapper to store 8 atoms in stack memory
     // We never read more than 8 args in the whole source code, so this prevents unnecessary memory copying
@@ -67,15 +69,16 @@ class MessageDispatcher {
 public:
     MessageDispatcher()
     {
-        usedHashes.reserve(stackSize);
-        nullListeners.reserve(stackSize);
+        usedHashes.reserve(initialStackSize);
     }
 
     void enqueueMessage(void* target, t_symbol* symbol, int argc, t_atom* argv)
     {
         if(block) return;
         
-        messageStack.push({ target, symbol, argc, argv });
+        Message message(target, symbol, argc, argv);
+        if (!messageStack.push(message))
+            backupQueue.try_enqueue(backupProducer, message);
     }
     
     // used when no plugineditor is active, so we can just ignore messages
@@ -90,9 +93,20 @@ public:
             while (messageStack.pop(message)) {}
             messageStack.swapBuffers();
             while (messageStack.pop(message)) {}
+            while (backupQueue.try_dequeue(message)) {}
+            deferredMessages.clear();
         }
     }
 
+    // When the GUI can't keep up, objects that were updated less than this many milliseconds ago have to wait for a later frame
+    // Their latest message is kept, so they still end up in the right state
+    void setMinimumUpdateInterval(double intervalMs)
+    {
+        minimumUpdateInterval = intervalMs;
+        if (minimumUpdateInterval <= 0.0)
+            lastUpdateTimes.clear();
+    }
+
     void addMessageListener(void* object, pd::MessageListener* messageListener)
     {
         ScopedLock lock(messageListenerLock);
@@ -112,8 +126,16 @@ public:
         if (it != listeners.end())
             listeners.erase(it);
 
-        if (listeners.empty())
+        if (listeners.empty()) {
             messageListeners.erase(object);
+            lastUpdateTimes.erase(object); // The object is gone, or nobody listens to it anymore
+        }
+    }
+
+    // If this is false, dequeueMessages() has nothing to do
+    bool hasPendingMessages()
+    {
+        return !deferredMessages.empty() || !messageStack.isEmpty() || backupQueue.size_approx() > 0;
     }
 
     void dequeueMessages() // Note: make sure correct pd instance is active when calling this
@@ -122,8 +144,40 @@ public:
         nullListeners.clear();
 
         messageStack.swapBuffers();
+
+        // The backup queue is in the order the messages came in, so we read it back to front, like the stack
+        overflowMessages.clear();
+        Message overflowMessage;
+        while (backupQueue.try_dequeue(overflowMessage))
+            overflowMessages.push_back(overflowMessage);
+
+        auto const now = Time::getMillisecondCounterHiRes();
+        auto const throttle = minimumUpdateInterval > 0.0;
+
+        // Messages that were held back last time are older than the new ones, so they come last and lose out against newer messages to the same target
+        std::swap(deferredMessages, previouslyDeferredMessages);
+        deferredMessages.clear();
+        size_t deferredIndex = 0;
+
         Message message;
-        while (messageStack.pop(message)) {
+        auto popMessage = [this, &message, &deferredIndex]() {
+            if (!overflowMessages.empty()) {
+                message = overflowMessages.back();
+                overflowMessages.pop_back();
+                return true;
+            }
+
+            if (messageStack.pop(message))
+                return true;
+
+            if (deferredIndex < previouslyDeferredMessages.size()) {
+                message = previouslyDeferredMessages[deferredIndex++];
+                return true;
+            }
+            return false;
+        };
+
+        while (popMessage()) {
             auto hash = reinterpret_cast<intptr_t>(message.target) ^ reinterpret_cast<intptr_t>(message.symbol);
             if (usedHashes.find(hash) != usedHashes.end()) {
                 continue;
@@ -133,6 +187,15 @@ public:
             if (messageListeners.find(message.target) == messageListeners.end())
                 continue;
 
+            if (throttle) {
+                auto& lastUpdate = lastUpdateTimes[message.target];
+                if (lastUpdate != now && now - lastUpdate < minimumUpdateInterval) {
+                    deferredMessages.push_back(message);
+                    continue;
+                }
+                lastUpdate = now;
+            }
+
             for (auto it = messageListeners.at(message.target).begin(); it != messageListeners.at(message.target).end(); ++it) {
                 if (it->wasObjectDeleted())
                     continue;
@@ -148,27 +211,57 @@ public:
                 if (listener)
                     listener->receiveMessage(symbol, atoms, message.size);
                 else
-                    nullListeners.push_back({ message.target, it });
+                    nullListeners.push_back(message.target);
+            }
+        }
+
+        // A target can show up here more than once, if it received several messages
+        for (auto* target : nullListeners) {
+            auto listeners = messageListeners.find(target);
+            if (listeners == messageListeners.end())
+                continue;
+
+            std::erase_if(listeners->second, [](auto const& listener) { return listener.wasObjectDeleted(); });
+            if (listeners->second.empty()) {
+                messageListeners.erase(listeners);
+                lastUpdateTimes.erase(target);
             }
         }
+    }
+
+    // Approximate number of bytes used by the message buffers and listener bookkeeping
+    size_t getMemoryUsage()
+    {
+        ScopedLock lock(messageListenerLock);
 
-        for (int i = nullListeners.size() - 1; i >= 0; i--) {
-            auto& [target, iterator] = nullListeners[i];
-            messageListeners[target].erase(iterator);
+        size_t listenerMemory = 0;
+        for (auto const& [object, listeners] : messageListeners) {
+            listenerMemory += sizeof(void*) + listeners.size() * sizeof(juce::WeakReference<MessageListener>) * 2;
         }
+
+        return messageStack.getMemoryUsage() + usedHashes.bucket_count() * sizeof(void*) + usedHashes.size() * sizeof(intptr_t) * 2 + listenerMemory;
     }
 
 private:
-    static constexpr int stackSize = 65536;
-    using MessageStack = ThreadSafeStack<Message, stackSize>;
+    // The stacks start out with room for this many messages, and the message thread grows them when a block uses more than half of that
+    static constexpr int initialStackSize = 1024;
+    using MessageStack = ThreadSafeStack<Message, initialStackSize>;
 
-    std::vector<std::pair<void*, std::set<juce::WeakReference<pd::MessageListener>>::iterator>> nullListeners;
+    std::vector<void*> nullListeners; // Targets that have listeners which were deleted
     std::unordered_set<intptr_t> usedHashes;
     MessageStack messageStack;
 
-    // Queue to use in case our fast stack queue is full
+    double minimumUpdateInterval = 0.0;
+    std::unordered_map<void*, double> lastUpdateTimes;
+    std::vector<Message> deferredMessages, previouslyDeferredMessages, overflowMessages;
+
+    // Queue to use in case our fast stack queue is full, it only takes what fits in its preallocated blocks
     moodycamel::ConcurrentQueue<Message> backupQueue;
 
+    // Messages are only enqueued while pd is locked, so they never come from two threads at once
+    // With a token made up front, the first overflow doesn't allocate a producer on the audio thread either
+    moodycamel::ProducerToken backupProducer { backupQueue };
+
     std::unordered_map<void*, std::set<juce::WeakReference<MessageListener>>> messageListeners;
     CriticalSection messageListenerLock;
 
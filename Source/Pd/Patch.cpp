@@ -3,16 +3,20 @@
  // For information on usage and redistribution, and for a DISCLAIMER OF ALL
  // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
  */
-#include <juce_gui_basics/juce_gui_basics.h>
+#if !PLUGDATA_HEADLESS
+#    include <juce_gui_basics/juce_gui_basics.h>
+#endif
 
 #include "Utility/Config.h"
-#include "Utility/Fonts.h"
 
 #include "Patch.h"
 #include "Instance.h"
 #include "Interface.h"
-#include "Objects/ObjectBase.h"
-#include "../PluginEditor.h"
+#include "Utility/ObjectThemeManager.h"
+
+#if !PLUGDATA_HEADLESS
+#    include "Utility/SettingsFile.h"
+#endif
 
 extern "C" {
 #include <m_pd.h>
@@ -31,7 +35,11 @@ namespace pd {
 Patch::Patch(pd::WeakReference patchPtr, Instance* parentInstance, bool ownsPatch, File patchFile)
     : instance(parentInstance)
     , closePatchOnDelete(ownsPatch)
+#if PLUGDATA_HEADLESS
+    , lastViewportScale(1.0f)
+#else
     , lastViewportScale(SettingsFile::getInstance()->getProperty<float>("default_zoom") / 100.0f)
+#endif
     , currentFile(std::move(patchFile))
     , ptr(patchPtr)
 {
@@ -99,9 +107,10 @@ void Patch::savePatch(URL const& locationURL)
     if (auto patch = ptr.get<t_glist>()) {
         setTitle(filename);
         untitledPatchNum = 0;
-        canvas_dirty(patch.get(), 0);
 
 #if JUCE_IOS
+        canvas_dirty(patch.get(), 0);
+
         auto patchText = getCanvasContent();
         auto outputStream = locationURL.createOutputStream();
 
@@ -112,13 +121,15 @@ void Patch::savePatch(URL const& locationURL)
 
         instance->logMessage("saved to: " + location.getFullPathName());
         canvas_rename(patch.get(), file, dir);
-#else
-        pd::Interface::saveToFile(patch.get(), file, dir);
-#endif
 
         currentFile = location;
         currentURL = locationURL;
         instance->reloadAbstractions(location, patch.get());
+#else
+        currentFile = location;
+        currentURL = locationURL;
+        writeToDisk(patch.get(), location.getParentDirectory().getChildFile(filename), file, dir);
+#endif
     }
 }
 
@@ -166,17 +177,53 @@ void Patch::savePatch()
     if (auto patch = ptr.get<t_glist>()) {
         setTitle(filename);
         untitledPatchNum = 0;
-        canvas_dirty(patch.get(), 0);
 
-        pd::Interface::saveToFile(patch.get(), file, dir);
+        writeToDisk(patch.get(), currentFile.getParentDirectory().getChildFile(filename), file, dir);
     }
+}
 
-    MessageManager::callAsync([instance = juce::WeakReference(this->instance), file = this->currentFile, ptr = this->ptr]() {
-        if (instance) {
-            if(auto patch = ptr.get<t_glist>()) {
-                instance->reloadAbstractions(file, patch.get());
+void Patch::writeToDisk(t_glist* patch, File const& location, t_symbol* file, t_symbol* dir)
+{
+    // binbuf_write() converts Max patches while it writes them, so those are still written by pd
+    if (location.hasFileExtension("pat;mxt")) {
+        pd::Interface::saveToFile(patch, file, dir);
+        return;
+    }
+
+    // The patch only counts as saved once the file is on disk, so a failed write leaves it dirty
+    auto content = pd::Interface::saveToMemory(patch);
+    auto const contentHash = std::hash<std::string>()(content);
+    auto const undoPosition = pd::Interface::getUndoPosition(patch);
+
+    instance->patchWriter->write(location, std::move(content), [instance = juce::WeakReference(this->instance), location, ptr = this->ptr, file, dir, contentHash, undoPosition](bool const succeeded) {
+        MessageManager::callAsync([instance, location, ptr, file, dir, contentHash, undoPosition, succeeded]() {
+            if (!instance)
+                return;
+
+            if (!succeeded) {
+                instance->logError("Failed to save: " + location.getFullPathName());
+                return;
             }
-        }
+
+            instance->logMessage("saved to: " + location.getFullPathName());
+
+            auto patch = ptr.get<t_glist>();
+            if (!patch)
+                return;
+
+            // Edits made while the file was being written aren't in it, so those keep the patch dirty
+            // The undo position catches most edits without serialising again, the hash catches the rest
+            instance->setThis();
+            instance->lockAudioThread();
+            auto const isUpToDate = pd::Interface::getUndoPosition(patch.get()) == undoPosition
+                && std::hash<std::string>()(pd::Interface::saveToMemory(patch.get())) == contentHash;
+            pd::Interface::setSaved(patch.get(), file, dir, isUpToDate);
+            instance->unlockAudioThread();
+
+            // Reloading synchronises every open canvas, so only do that if the file is actually used somewhere else
+            if (pd::Interface::isPatchInstantiated(file, dir, patch.get()))
+                instance->reloadAbstractions(location, patch.get());
+        });
     });
 }
 
@@ -337,8 +384,10 @@ void Patch::copy(std::vector<t_gobj*> const& objects)
     if (auto patch = ptr.get<t_glist>()) {
         int size;
         char const* text = pd::Interface::copy(patch.get(), &size, objects);
+#if !PLUGDATA_HEADLESS
         auto copied = String::fromUTF8(text, size);
         MessageManager::callAsync([copied]() mutable { SystemClipboard::copyTextToClipboard(copied); });
+#endif
     }
 }
 
@@ -436,7 +485,16 @@ String Patch::translatePatchAsString(String const& patchAsString, Point<int> pos
 
 void Patch::paste(Point<int> position)
 {
+#if PLUGDATA_HEADLESS
+    // No system clipboard without a GUI runtime, paste from Pd's own copy buffer instead
+    char* buf;
+    int bufsize;
+    binbuf_gettext(pd::Interface::getInstanceEditor()->copy_binbuf, &buf, &bufsize);
+    auto text = String::fromUTF8(buf, bufsize);
+    freebytes(static_cast<void*>(buf), static_cast<size_t>(bufsize));
+#else
     auto text = SystemClipboard::getTextFromClipboard();
+#endif
 
     auto translatedObjects = translatePatchAsString(text, position);
 
@@ -100,9 +100,9 @@ public:
 
     Connections getConnections() const;
 
-    WeakReference::Ptr<t_canvas> getPointer() const
+    WeakReference::Ptr<t_canvas> getPointer(std::source_location const& location = std::source_location::current()) const
     {
-        return ptr.get<t_canvas>();
+        return ptr.get<t_canvas>(location);
     }
     
     t_canvas* getUncheckedPointer() const
@@ -117,6 +117,10 @@ public:
 
     static void reloadPatch(File const& changedPatch, t_glist* except);
 
+    // Serialises the patch and writes it on the instance's PatchWriter
+    // Once it's written, the patch is marked as saved and other instances of the file are reloaded
+    void writeToDisk(t_glist* patch, File const& location, t_symbol* file, t_symbol* dir);
+
     String getTitle() const;
     void setTitle(String const& title);
     void setUntitled();
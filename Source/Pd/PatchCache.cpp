@@ -0,0 +1,191 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "Utility/Config.h"
+#include <juce_cryptography/juce_cryptography.h>
+
+#include "PatchCache.h"
+
+namespace pd {
+
+bool PatchCache::canCache(File const& patchFile)
+{
+    return patchFile.hasFileExtension("pd");
+}
+
+File PatchCache::getCacheFile(File const& patchFile)
+{
+    return patchFile.withFileExtension("pdc");
+}
+
+// A collision must never load the wrong patch, so this has to be a strong hash
+MemoryBlock PatchCache::getContentHash(MemoryBlock const& content)
+{
+    return SHA256(content).getRawData();
+}
+
+bool PatchCache::readCache(File const& cacheFile, MemoryBlock const& source, Content& result)
+{
+    FileInputStream input(cacheFile);
+    if (!input.openedOk())
+        return false;
+
+    if (static_cast<uint32>(input.readInt()) != magic || static_cast<uint32>(input.readInt()) != version)
+        return false;
+
+    // Symbols and floats depend on the build, so a cache from another plugdata version is never reused
+    if (input.readString() != ProjectInfo::versionString)
+        return false;
+
+    // The length is checked first, so a changed patch is usually rejected without hashing it
+    if (input.readInt64() != static_cast<int64>(source.getSize()))
+        return false;
+
+    auto const sourceHash = getContentHash(source);
+    MemoryBlock cachedHash(sourceHash.getSize());
+    if (input.read(cachedHash.getData(), static_cast<int>(cachedHash.getSize())) != static_cast<int>(cachedHash.getSize()) || cachedHash != sourceHash)
+        return false;
+
+    // The sizes below come from the file, so they're checked against what's left of it before we allocate anything
+    // Every symbol and atom takes up at least one byte
+    auto const getRemainingBytes = [&input]() { return input.getTotalLength() - input.getPosition(); };
+
+    auto const numSymbols = input.readInt();
+    if (numSymbols < 0 || numSymbols > getRemainingBytes())
+        return false;
+
+    auto& symbols = result.symbols;
+    symbols.clear();
+    symbols.reserve(numSymbols);
+    for (int i = 0; i < numSymbols; i++) {
+        // Symbol names are stored as raw bytes, since they don't have to be valid UTF-8
+        auto const length = input.readInt();
+        if (length < 0 || length > getRemainingBytes())
+            return false;
+
+        auto& symbol = symbols.emplace_back(static_cast<size_t>(length), '\0');
+        if (input.read(symbol.data(), length) != length)
+            return false;
+    }
+
+    auto const numAtoms = input.readInt();
+    if (numAtoms < 0 || numAtoms > getRemainingBytes())
+        return false;
+
+    auto& atoms = result.atoms;
+    atoms.resize(numAtoms);
+    for (auto& atom : atoms) {
+        auto const type = static_cast<t_atomtype>(input.readByte());
+        switch (type) {
+        case A_FLOAT:
+            SETFLOAT(&atom, static_cast<t_float>(input.readDouble()));
+            break;
+        case A_SYMBOL:
+        case A_DOLLSYM: {
+            auto const index = input.readInt();
+            if (!isPositiveAndBelow(index, numSymbols))
+                return false;
+
+            atom.a_type = type;
+            atom.a_w.w_index = index;
+            break;
+        }
+        case A_DOLLAR:
+            SETDOLLAR(&atom, input.readInt());
+            break;
+        case A_SEMI:
+            SETSEMI(&atom);
+            break;
+        case A_COMMA:
+            SETCOMMA(&atom);
+            break;
+        default:
+            return false;
+        }
+    }
+
+    // A truncated or padded cache means it was corrupted
+    if (input.getPosition() != input.getTotalLength())
+        return false;
+
+    return true;
+}
+
+void PatchCache::addToBinbuf(Content const& content, t_binbuf* result)
+{
+    std::vector<t_symbol*> symbols;
+    symbols.reserve(content.symbols.size());
+    for (auto const& symbol : content.symbols) {
+        symbols.push_back(gensym(symbol.c_str()));
+    }
+
+    auto atoms = content.atoms;
+    for (auto& atom : atoms) {
+        if (atom.a_type == A_SYMBOL || atom.a_type == A_DOLLSYM) {
+            atom.a_w.w_symbol = symbols[atom.a_w.w_index];
+        }
+    }
+
+    binbuf_clear(result);
+    binbuf_add(result, static_cast<int>(atoms.size()), atoms.data());
+}
+
+void PatchCache::writeCache(File const& cacheFile, MemoryBlock const& source, t_binbuf* content)
+{
+    auto const numAtoms = binbuf_getnatom(content);
+    auto const* atoms = binbuf_getvec(content);
+
+    std::vector<t_symbol*> symbols;
+    std::unordered_map<t_symbol*, int> symbolIndices;
+    for (int i = 0; i < numAtoms; i++) {
+        if (atoms[i].a_type == A_SYMBOL || atoms[i].a_type == A_DOLLSYM) {
+            if (symbolIndices.try_emplace(atoms[i].a_w.w_symbol, static_cast<int>(symbols.size())).second)
+                symbols.push_back(atoms[i].a_w.w_symbol);
+        }
+    }
+
+    MemoryOutputStream output;
+    output.writeInt(static_cast<int>(magic));
+    output.writeInt(static_cast<int>(version));
+    output.writeString(ProjectInfo::versionString);
+    output.writeInt64(static_cast<int64>(source.getSize()));
+    output << getContentHash(source);
+
+    output.writeInt(static_cast<int>(symbols.size()));
+    for (auto* symbol : symbols) {
+        auto const length = static_cast<int>(std::strlen(symbol->s_name));
+        output.writeInt(length);
+        output.write(symbol->s_name, static_cast<size_t>(length));
+    }
+
+    output.writeInt(numAtoms);
+    for (int i = 0; i < numAtoms; i++) {
+        auto const& atom = atoms[i];
+        output.writeByte(static_cast<char>(atom.a_type));
+        switch (atom.a_type) {
+        case A_FLOAT:
+            output.writeDouble(atom.a_w.w_float);
+            break;
+        case A_SYMBOL:
+        case A_DOLLSYM:
+            output.writeInt(symbolIndices[atom.a_w.w_symbol]);
+            break;
+        case A_DOLLAR:
+            output.writeInt(atom.a_w.w_index);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Write to a temporary file first, so a crash can never leave a half-written cache behind
+    TemporaryFile tempFile(cacheFile);
+    if (tempFile.getFile().replaceWithData(output.getData(), output.getDataSize())) {
+        tempFile.overwriteTargetFileWithTemporary();
+    }
+}
+
+} // namespace pd
@@ -0,0 +1,51 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+extern "C" {
+#include <m_pd.h>
+}
+
+#include "Utility/Config.h"
+
+namespace pd {
+
+// Binary sidecar cache for .pd files, stored next to the patch as "name.pdc"
+// It contains the patch as an already tokenised atom stream, plus a table of the symbols it uses,
+// so opening a large patch doesn't have to go through Pd's text parser again
+// The cache stores the length and SHA-256 hash of the .pd source it was made from, and is regenerated when those don't match the file
+// Patches are read through the cache by PatchLoader
+struct PatchCache {
+
+    // Patch contents decoded from a cache file
+    // Symbols are stored by their index into the symbol table, and only become pd symbols in addToBinbuf()
+    // That way, decoding a cache doesn't touch pd and can happen on any thread
+    struct Content {
+        std::vector<std::string> symbols;
+        std::vector<t_atom> atoms;
+    };
+
+    // Thread-safe, returns false if the cache is missing, corrupt or wasn't made from this source
+    static bool readCache(File const& cacheFile, MemoryBlock const& source, Content& result);
+
+    // Needs to be called with the pd lock held and the right pd instance active
+    static void addToBinbuf(Content const& content, t_binbuf* result);
+    static void writeCache(File const& cacheFile, MemoryBlock const& source, t_binbuf* content);
+
+    static MemoryBlock getContentHash(MemoryBlock const& content);
+
+    static File getCacheFile(File const& patchFile);
+
+    // Only plain .pd files are cached, Max patches still go through Pd's importer
+    static bool canCache(File const& patchFile);
+
+private:
+    static constexpr uint32 magic = 0x31434450; // "PDC1"
+    static constexpr uint32 version = 3;
+};
+
+} // namespace pd
@@ -0,0 +1,111 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "Utility/Config.h"
+
+#include "PatchLoader.h"
+
+namespace pd {
+
+bool PatchLoader::canPrepare(Source const& source)
+{
+#if JUCE_IOS
+    return source.content.isNotEmpty();
+#else
+    return source.content.isNotEmpty() || source.location.hasFileExtension("pd");
+#endif
+}
+
+PatchLoader::PreparedPatch PatchLoader::prepare(Source const& source)
+{
+    PreparedPatch prepared;
+    prepared.location = source.location;
+
+    if (!canPrepare(source))
+        return prepared;
+
+    if (source.content.isNotEmpty()) {
+        prepared.text.append(source.content.toRawUTF8(), source.content.getNumBytesAsUTF8());
+        prepared.isValid = true;
+        return prepared; // Content from a saved state isn't cached, since it has no file to tie the cache to
+    }
+
+    if (!source.location.loadFileAsData(prepared.text))
+        return prepared;
+
+    prepared.isValid = true;
+    prepared.useCache = source.useCache && PatchCache::canCache(source.location);
+
+    if (prepared.useCache) {
+        auto const cacheFile = PatchCache::getCacheFile(source.location);
+        prepared.hasCachedContent = cacheFile.existsAsFile() && PatchCache::readCache(cacheFile, prepared.text, prepared.cachedContent);
+    }
+
+    return prepared;
+}
+
+std::vector<PatchLoader::PreparedPatch> PatchLoader::prepare(std::vector<Source> const& sources, int const numThreads)
+{
+    std::vector<PreparedPatch> prepared(sources.size());
+
+    auto const numWorkers = std::min<int>(numThreads, static_cast<int>(sources.size()));
+    if (numWorkers <= 1) {
+        for (size_t i = 0; i < sources.size(); i++) {
+            prepared[i] = prepare(sources[i]);
+        }
+        return prepared;
+    }
+
+    std::atomic<size_t> numRemaining = sources.size();
+    WaitableEvent finished;
+
+    ThreadPool pool(numWorkers);
+    for (size_t i = 0; i < sources.size(); i++) {
+        pool.addJob([&prepared, &sources, &numRemaining, &finished, i]() {
+            prepared[i] = prepare(sources[i]);
+            if (--numRemaining == 0)
+                finished.signal();
+        });
+    }
+
+    finished.wait();
+
+    return prepared;
+}
+
+void PatchLoader::tokenise(PreparedPatch& prepared)
+{
+    if (!prepared.isValid || prepared.hasCachedContent || prepared.tokenisedContent)
+        return;
+
+    prepared.tokenisedContent = std::shared_ptr<t_binbuf>(binbuf_new(), binbuf_free);
+    binbuf_text(prepared.tokenisedContent.get(), static_cast<char const*>(prepared.text.getData()), static_cast<int>(prepared.text.getSize()));
+}
+
+void PatchLoader::writeCache(PreparedPatch const& prepared)
+{
+    // Only reads the atoms and symbol names, which pd never changes once they exist
+    if (prepared.useCache && prepared.tokenisedContent) {
+        PatchCache::writeCache(PatchCache::getCacheFile(prepared.location), prepared.text, prepared.tokenisedContent.get());
+    }
+}
+
+void PatchLoader::addToBinbuf(PreparedPatch const& prepared, t_binbuf* result)
+{
+    if (prepared.hasCachedContent) {
+        PatchCache::addToBinbuf(prepared.cachedContent, result);
+        return;
+    }
+
+    binbuf_clear(result);
+    if (prepared.tokenisedContent) {
+        binbuf_add(result, binbuf_getnatom(prepared.tokenisedContent.get()), binbuf_getvec(prepared.tokenisedContent.get()));
+    } else {
+        binbuf_text(result, static_cast<char const*>(prepared.text.getData()), static_cast<int>(prepared.text.getSize()));
+    }
+}
+
+} // namespace pd
@@ -0,0 +1,57 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include "PatchCache.h"
+
+namespace pd {
+
+// Splits opening patches into stages, so several patches can be loaded at once, and the pd lock is only held for what needs it
+// First, the patch files are read and their caches decoded. This doesn't touch pd, so we do that for all patches in parallel
+// Patches without a usable cache are then tokenised, which creates pd symbols, so that takes the pd lock for one patch at a time
+// Their new caches are written after releasing it. See Instance::preparePatches()
+// After that, Instance::openPatch(PreparedPatch) turns them into pd canvases one by one, under the pd lock
+struct PatchLoader {
+
+    struct Source {
+        String content; // If this is empty, the patch will be read from location
+        File location;  // Used to resolve abstractions, may be empty for untitled patches
+        bool useCache = false;
+    };
+
+    struct PreparedPatch {
+        File location;
+        MemoryBlock text;
+        bool useCache = false;
+        bool hasCachedContent = false;
+        PatchCache::Content cachedContent;
+        std::shared_ptr<t_binbuf> tokenisedContent;
+        bool isValid = false;
+    };
+
+    // Sources we can prepare: patch content from a saved state, and plain .pd files
+    // Max patches need pd's importer, and on iOS files have to be read through their URL, so those are opened through libpd_openfile
+    static bool canPrepare(Source const& source);
+
+    static PreparedPatch prepare(Source const& source);
+
+    // Prepares all patches on up to numThreads threads, the results are in the same order as sources
+    static std::vector<PreparedPatch> prepare(std::vector<Source> const& sources, int numThreads = SystemStats::getNumCpus());
+
+    // Parses the text of a patch that has no usable cache
+    // Needs to be called with the pd lock held and the right pd instance active
+    static void tokenise(PreparedPatch& prepared);
+
+    // Writes a new cache for a tokenised patch, this doesn't need the pd lock
+    static void writeCache(PreparedPatch const& prepared);
+
+    // Fills the binbuf with the contents of the prepared patch
+    // Needs to be called with the pd lock held and the right pd instance active
+    static void addToBinbuf(PreparedPatch const& prepared, t_binbuf* result);
+};
+
+} // namespace pd
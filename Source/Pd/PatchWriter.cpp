@@ -0,0 +1,91 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "Utility/Config.h"
+
+#include "PatchWriter.h"
+
+namespace pd {
+
+PatchWriter::PatchWriter(WriteFunction writeFile)
+    : Thread("Patch Writer")
+    , writeFile(std::move(writeFile))
+{
+}
+
+PatchWriter::~PatchWriter()
+{
+    {
+        std::lock_guard lock(jobsMutex);
+        shouldQuit = true;
+    }
+    jobsChanged.notify_all();
+
+    // The thread only exits once all jobs are done, so nothing that was saved gets lost on quit
+    waitForThreadToExit(-1);
+}
+
+void PatchWriter::write(File const& file, std::string content, std::function<void(bool)> onWritten)
+{
+    {
+        std::lock_guard lock(jobsMutex);
+        jobs.push_back({ file, std::move(content), std::move(onWritten) });
+        numPendingJobs++;
+    }
+    jobsChanged.notify_all();
+
+    // Most instances never save anything, so the thread is only started when it's needed
+    if (!isThreadRunning())
+        startThread();
+}
+
+void PatchWriter::waitForPendingWrites()
+{
+    std::unique_lock lock(jobsMutex);
+    jobsChanged.wait(lock, [this]() { return numPendingJobs == 0; });
+}
+
+bool PatchWriter::writeToFile(File const& file, std::string const& content)
+{
+    // Write to a temporary file first, so a crash or a full disk can never leave a half-written patch behind
+    TemporaryFile tempFile(file);
+    if (!tempFile.getFile().replaceWithData(content.data(), content.size()))
+        return false;
+
+    return tempFile.overwriteTargetFileWithTemporary();
+}
+
+void PatchWriter::run()
+{
+    while (true) {
+        {
+            Job job;
+            {
+                std::unique_lock lock(jobsMutex);
+                jobsChanged.wait(lock, [this]() { return !jobs.empty() || shouldQuit; });
+                if (jobs.empty())
+                    return;
+
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            auto const succeeded = writeFile(job.file, job.content);
+            if (job.onWritten)
+                job.onWritten(succeeded);
+        }
+
+        // The job is destroyed before it counts as done, so waitForPendingWrites() also waits for whatever its callback holds on to
+
+        {
+            std::lock_guard lock(jobsMutex);
+            numPendingJobs--;
+        }
+        jobsChanged.notify_all();
+    }
+}
+
+} // namespace pd
@@ -0,0 +1,55 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace pd {
+
+// Writes saved patches to disk on a background thread, so a slow disk never holds up pd or the audio thread
+// Patch::savePatch() serialises the patch under the pd lock, and hands the text to this class
+// Writes happen in the order they were queued, and go through a temporary file that replaces the target when it's complete
+class PatchWriter : private Thread {
+public:
+    using WriteFunction = std::function<bool(File const&, std::string const&)>;
+
+    // writeFile does the actual writing, and can be replaced to simulate a slow disk
+    explicit PatchWriter(WriteFunction writeFile = writeToFile);
+
+    // Finishes all pending writes before returning
+    ~PatchWriter() override;
+
+    // onWritten is called on the writer thread, with whether the write succeeded
+    void write(File const& file, std::string content, std::function<void(bool)> onWritten = nullptr);
+
+    // Blocks until everything that was queued so far has been written
+    void waitForPendingWrites();
+
+    static bool writeToFile(File const& file, std::string const& content);
+
+private:
+    void run() override;
+
+    // Only set in the constructor, so the writer thread can read it without locking
+    WriteFunction const writeFile;
+
+    struct Job {
+        File file;
+        std::string content;
+        std::function<void(bool)> onWritten;
+    };
+
+    std::mutex jobsMutex;
+    std::condition_variable jobsChanged;
+    std::deque<Job> jobs;
+    int numPendingJobs = 0;
+    bool shouldQuit = false;
+};
+
+} // namespace pd
@@ -5,7 +5,6 @@
  */
 
 #include "Utility/Config.h"
-#include <juce_gui_basics/juce_gui_basics.h>
 
 extern "C" {
 #include <s_inter.h>
@@ -18,7 +17,7 @@ pd::WeakReference::WeakReference(void* p, Instance* instance)
     : ptr(p)
     , pd(instance)
 {
-    pd->registerWeakReference(ptr, &weakRef);
+    weakRef = pd->weakReferences.getHandle(ptr);
 }
 
 pd::WeakReference::WeakReference(Instance* instance)
@@ -27,43 +26,20 @@ pd::WeakReference::WeakReference(Instance* instance)
 {
 }
 
-pd::WeakReference::WeakReference(WeakReference const& toCopy)
-    : ptr(toCopy.ptr)
-    , pd(toCopy.pd)
+void pd::lockInstance(Instance* instance, std::source_location const& location)
 {
-    pd->weakReferenceMutex.lock();
-
-    weakRef = toCopy.weakRef.load();
-    pd->registerWeakReference(ptr, &weakRef);
-
-    pd->weakReferenceMutex.unlock();
-}
-
-pd::WeakReference::~WeakReference()
-{
-    if (pd)
-        pd->unregisterWeakReference(ptr, &weakRef);
+    if (instance)
+        instance->lockAudioThread(location);
+    else
+        sys_lock();
 }
 
-pd::WeakReference& pd::WeakReference::operator=(pd::WeakReference const& other)
+void pd::unlockInstance(Instance* instance)
 {
-    bool valid = other.ptr && other.pd;
-    if (valid && this != &other) // Check for self-assignment
-    {
-        pd = other.pd;
-
-        pd->weakReferenceMutex.lock();
-        pd->unregisterWeakReference(ptr, &other.weakRef);
-
-        // Use atomic exchange to safely copy the weakRef value
-        weakRef.store(other.weakRef.load());
-        ptr = other.ptr;
-
-        pd->registerWeakReference(ptr, &weakRef);
-        pd->weakReferenceMutex.unlock();
-    }
-
-    return *this;
+    if (instance)
+        instance->unlockAudioThread();
+    else
+        sys_unlock();
 }
 
 void pd::WeakReference::setThis() const
@@ -6,26 +6,28 @@
 #pragma once
 
 #include <functional>
-#include <unordered_map>
-#include <mutex>
+#include <source_location>
 
 #include <m_pd.h>
 
-using pd_weak_reference = std::atomic<bool>;
+#include "WeakReferenceRegistry.h"
 
 namespace pd {
 
 class Instance;
+
+// Takes the pd lock through the instance, so the lock telemetry knows where it was taken
+void lockInstance(Instance* instance, std::source_location const& location);
+void unlockInstance(Instance* instance);
+
 struct WeakReference {
     WeakReference(void* p, Instance* instance);
 
     WeakReference(Instance* instance);
 
-    WeakReference(WeakReference const& toCopy);
-
-    ~WeakReference();
-
-    WeakReference& operator=(WeakReference const& other);
+    // Copies only copy the handle, they don't have to register anything
+    WeakReference(WeakReference const& toCopy) = default;
+    WeakReference& operator=(WeakReference const& other) = default;
 
     bool operator==(WeakReference const& other) const
     {
@@ -42,32 +44,33 @@ struct WeakReference {
     template<typename T>
     struct Ptr {
 
-        Ptr(T* pointer, pd_weak_reference const& ref)
+        Ptr(T* pointer, WeakReferenceRegistry::Handle const& ref, Instance* instance, std::source_location const& location)
             : weakRef(ref)
             , ptr(pointer)
+            , pd(instance)
         {
-            sys_lock();
+            lockInstance(pd, location);
         }
 
         ~Ptr()
         {
-            sys_unlock();
+            unlockInstance(pd);
         }
 
         operator bool() const
         {
-            return weakRef && (ptr != nullptr);
+            return weakRef.isValid() && (ptr != nullptr);
         }
 
         T* get()
         {
-            return weakRef ? ptr : nullptr;
+            return weakRef.isValid() ? ptr : nullptr;
         }
 
         template<typename C>
         C* cast()
         {
-            return weakRef ? reinterpret_cast<C*>(ptr) : nullptr;
+            return weakRef.isValid() ? reinterpret_cast<C*>(ptr) : nullptr;
         }
 
         T* operator->()
@@ -75,24 +78,25 @@ struct WeakReference {
             return ptr;
         }
 
-        pd_weak_reference const& weakRef;
+        WeakReferenceRegistry::Handle const& weakRef;
         T* ptr;
+        Instance* pd;
 
         JUCE_DECLARE_NON_COPYABLE(Ptr)
     };
 
     template<typename T>
-    Ptr<T> get() const
+    Ptr<T> get(std::source_location const& location = std::source_location::current()) const
     {
         setThis();
-        return Ptr<T>(reinterpret_cast<T*>(ptr), weakRef);
+        return Ptr<T>(reinterpret_cast<T*>(ptr), weakRef, pd, location);
     }
 
     template<typename T>
     T* getRaw() const
     {
         setThis();
-        return weakRef ? reinterpret_cast<T*>(ptr) : nullptr;
+        return weakRef.isValid() ? reinterpret_cast<T*>(ptr) : nullptr;
     }
 
     template<typename T>
@@ -103,13 +107,13 @@ struct WeakReference {
 
     bool isValid()
     {
-        return weakRef && ptr != nullptr;
+        return weakRef.isValid() && ptr != nullptr;
     }
 
 private:
     void* ptr;
     Instance* pd;
-    pd_weak_reference weakRef = true;
+    WeakReferenceRegistry::Handle weakRef;
 };
 
 }
@@ -0,0 +1,169 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "Utility/Config.h"
+
+#include "WeakReferenceRegistry.h"
+
+namespace pd {
+
+WeakReferenceRegistry::Table::Table(int const tableSize)
+    : size(tableSize)
+    , slots(new Slot[tableSize])
+{
+}
+
+WeakReferenceRegistry::WeakReferenceRegistry() = default;
+
+WeakReferenceRegistry::~WeakReferenceRegistry()
+{
+    auto* table = firstTable.next.load();
+    while (table) {
+        auto* next = table->next.load();
+        delete table;
+        table = next;
+    }
+}
+
+size_t WeakReferenceRegistry::getHash(void* object)
+{
+    // Objects are at least 8-byte aligned, so the low bits don't tell them apart
+    auto value = reinterpret_cast<uintptr_t>(object) >> 3;
+    value ^= value >> 16;
+    value *= 0x45d9f3b;
+    value ^= value >> 16;
+    return static_cast<size_t>(value);
+}
+
+WeakReferenceRegistry::Table* WeakReferenceRegistry::getNextTable(Table* table)
+{
+    if (auto* next = table->next.load(std::memory_order_acquire))
+        return next;
+
+    auto* newTable = new Table(table->size * 4);
+    Table* expected = nullptr;
+    if (table->next.compare_exchange_strong(expected, newTable, std::memory_order_acq_rel))
+        return newTable;
+
+    // Another thread added one first
+    delete newTable;
+    return expected;
+}
+
+WeakReferenceRegistry::Handle WeakReferenceRegistry::getHandle(void* object)
+{
+    if (!object)
+        return {};
+
+    // An object can only be in one place, so it has to be looked up in every table before a tombstone is taken over
+    if (auto handle = findHandle(object); handle.slot)
+        return handle;
+
+    return insertHandle(object);
+}
+
+WeakReferenceRegistry::Handle WeakReferenceRegistry::findHandle(void* object)
+{
+    auto const hash = getHash(object);
+    for (auto* table = &firstTable; table; table = table->next.load(std::memory_order_acquire)) {
+        for (int i = 0; i < maxProbes; i++) {
+            auto& slot = table->slots[(hash + i) & (table->size - 1)];
+            auto* current = slot.object.load(std::memory_order_acquire);
+            if (current == nullptr)
+                break;
+
+            if (current == object)
+                return { &slot, slot.generation.load(std::memory_order_acquire) };
+        }
+    }
+    return {};
+}
+
+WeakReferenceRegistry::Handle WeakReferenceRegistry::insertHandle(void* object)
+{
+    auto const hash = getHash(object);
+    for (auto* table = &firstTable;; table = getNextTable(table)) {
+        // Keep at most half of a table live, so there's always a tombstone or an empty slot close by
+        // Once every slot has been used, probe sequences are maxProbes long, which bounds the cost of looking up objects that aren't here
+        auto const canInsert = table->numLive.load(std::memory_order_relaxed) < table->size / 2;
+
+        for (int i = 0; i < maxProbes; i++) {
+            auto& slot = table->slots[(hash + i) & (table->size - 1)];
+            auto* current = slot.object.load(std::memory_order_acquire);
+
+            if (current == getTombstone()) {
+                if (slot.object.compare_exchange_strong(current, object, std::memory_order_acq_rel)) {
+                    table->numLive.fetch_add(1, std::memory_order_relaxed);
+                    return { &slot, slot.generation.load(std::memory_order_acquire) };
+                }
+            } else if (current == nullptr) {
+                if (!canInsert)
+                    break;
+
+                if (slot.object.compare_exchange_strong(current, object, std::memory_order_acq_rel)) {
+                    table->numLive.fetch_add(1, std::memory_order_relaxed);
+                    return { &slot, slot.generation.load(std::memory_order_acquire) };
+                }
+            }
+
+            // Also covers losing the race above against another thread that inserted the same object
+            if (current == object)
+                return { &slot, slot.generation.load(std::memory_order_acquire) };
+        }
+    }
+}
+
+void WeakReferenceRegistry::invalidate(void* object)
+{
+    auto const hash = getHash(object);
+
+    // Two threads that insert the same object at the same time can end up with a slot in different tables, so we check all of them
+    // A probe sequence ends at the first empty slot, or after maxProbes slots
+    for (auto* table = &firstTable; table; table = table->next.load(std::memory_order_acquire)) {
+        for (int i = 0; i < maxProbes; i++) {
+            auto& slot = table->slots[(hash + i) & (table->size - 1)];
+            auto* current = slot.object.load(std::memory_order_acquire);
+            if (current == nullptr)
+                break;
+
+            if (current == object) {
+                // The generation has to change before the slot can be reused, otherwise a new object could inherit the old references
+                slot.generation.fetch_add(1, std::memory_order_acq_rel);
+                if (slot.object.compare_exchange_strong(current, getTombstone(), std::memory_order_acq_rel))
+                    table->numLive.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+int WeakReferenceRegistry::getNumSlots() const
+{
+    int numSlots = 0;
+    for (auto const* table = &firstTable; table; table = table->next.load(std::memory_order_acquire)) {
+        numSlots += table->numLive.load(std::memory_order_relaxed);
+    }
+    return numSlots;
+}
+
+int WeakReferenceRegistry::getNumTables() const
+{
+    int numTables = 0;
+    for (auto const* table = &firstTable; table; table = table->next.load(std::memory_order_acquire)) {
+        numTables++;
+    }
+    return numTables;
+}
+
+size_t WeakReferenceRegistry::getMemoryUsage() const
+{
+    size_t memory = 0;
+    for (auto const* table = &firstTable; table; table = table->next.load(std::memory_order_acquire)) {
+        memory += sizeof(Table) + table->size * sizeof(Slot);
+    }
+    return memory;
+}
+
+} // namespace pd
@@ -0,0 +1,79 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace pd {
+
+// Keeps track of which pd objects are still alive, for pd::WeakReference
+// Every object that has been referenced gets a slot with a generation counter, and freeing the object increments it
+// A weak reference remembers its slot and the generation it saw, so it stays valid until the generation changes
+// Copying a reference doesn't touch the registry, and freeing an object that was never referenced only costs a hash table probe
+// Nothing here takes a lock. Freeing an object leaves a tombstone in its slot, which the next object that probes past it takes over
+// The generation keeps counting up when a slot is reused, so references to the old object stay invalid
+class WeakReferenceRegistry {
+public:
+    struct Slot {
+        std::atomic<void*> object = nullptr;
+        std::atomic<uint32> generation = 1;
+    };
+
+    struct Handle {
+        Slot* slot = nullptr;
+        uint32 generation = 0;
+
+        bool isValid() const
+        {
+            return slot && slot->generation.load(std::memory_order_acquire) == generation;
+        }
+    };
+
+    WeakReferenceRegistry();
+    ~WeakReferenceRegistry();
+
+    // Returns a handle that is valid until invalidate() is called for the object
+    Handle getHandle(void* object);
+
+    // Called for every object that pd frees
+    void invalidate(void* object);
+
+    // Number of slots that belong to objects that haven't been freed
+    int getNumSlots() const;
+    int getNumTables() const;
+    size_t getMemoryUsage() const;
+
+private:
+    // When a table has too many live objects, a bigger one is chained after it
+    // Freed objects don't count, so the chain only grows with the number of objects that are referenced at the same time
+    struct Table {
+        explicit Table(int size);
+
+        int const size;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<int> numLive = 0;
+        std::atomic<Table*> next = nullptr;
+    };
+
+    static constexpr int initialTableSize = 1024;
+    static constexpr int maxProbes = 16;
+
+    static size_t getHash(void* object);
+    Table* getNextTable(Table* table);
+
+    Handle findHandle(void* object);
+    Handle insertHandle(void* object);
+
+    // Marks a slot whose object was freed, it can't be nullptr because that ends a probe sequence
+    static inline char tombstoneMarker = 0;
+    static void* getTombstone() { return &tombstoneMarker; }
+
+    Table firstTable { initialTableSize };
+};
+
+} // namespace pd
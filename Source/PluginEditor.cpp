@@ -20,7 +20,7 @@
 #include "Sidebar/Palettes.h"
 #include "Utility/Autosave.h"
 
-#include "Utility/RateReducer.h"
+#include "Utility/InputCoalescer.h"
 #include "Utility/StackShadow.h"
 
 #include "Canvas.h"
@@ -298,7 +298,7 @@ void PluginEditor::setUseBorderResizer(bool shouldUse)
     if (shouldUse) {
         if (ProjectInfo::isStandalone) {
             if (!borderResizer) {
-                borderResizer = std::make_unique<MouseRateReducedComponent<ResizableBorderComponent>>(getTopLevelComponent(), &constrainer);
+                borderResizer = std::make_unique<MouseCoalescedComponent<ResizableBorderComponent>>(getTopLevelComponent(), &constrainer);
                 borderResizer->setAlwaysOnTop(true);
                 addAndMakeVisible(borderResizer.get());
             }
@@ -310,7 +310,7 @@ void PluginEditor::setUseBorderResizer(bool shouldUse)
             }
         } else {
             if (!cornerResizer) {
-                cornerResizer = std::make_unique<MouseRateReducedComponent<ResizableCornerComponent>>(this, &pluginConstrainer);
+                cornerResizer = std::make_unique<MouseCoalescedComponent<ResizableCornerComponent>>(this, &pluginConstrainer);
                 cornerResizer->setAlwaysOnTop(true);
             }
             addAndMakeVisible(cornerResizer.get());
@@ -395,6 +395,17 @@ void PluginEditor::renderArea(NVGcontext* nvg, Rectangle<int> area)
     }
 }
 
+RectangleList<int> PluginEditor::getCanvasOverlayBounds()
+{
+    RectangleList<int> overlays;
+    if (touchSelectionHelper && touchSelectionHelper->isVisible()) {
+        overlays.add(touchSelectionHelper->getBounds() - nvgSurface.getPosition());
+    }
+
+    overlays.add(tabComponent.getOverlayBounds());
+    return overlays;
+}
+
 CallOutBox& PluginEditor::showCalloutBox(std::unique_ptr<Component> content, Rectangle<int> screenBounds)
 {
     class CalloutDeletionListener : public ComponentListener {
@@ -1624,7 +1635,7 @@ bool PluginEditor::highlightSearchTarget(void* target, bool openNewTabIfNeeded)
         return nullptr;
     };
 
-    ScopedLock audioLock(pd->audioLock);
+    pd->lockAudioThread();
 
     t_glist* targetCanvas = nullptr;
     for (auto* glist = pd_getcanvaslist(); glist; glist = glist->gl_next) {
@@ -1635,6 +1646,10 @@ bool PluginEditor::highlightSearchTarget(void* target, bool openNewTabIfNeeded)
         }
     }
 
+    // Take the reference while we hold the lock, so we know if the canvas gets freed later
+    auto const targetReference = pd::WeakReference(targetCanvas, pd);
+    pd->unlockAudioThread();
+
     if (!targetCanvas)
         return false;
 
@@ -1672,7 +1687,7 @@ bool PluginEditor::highlightSearchTarget(void* target, bool openNewTabIfNeeded)
     }
 
     if (openNewTabIfNeeded) {
-        auto* cnv = tabComponent.openPatch(new pd::Patch(pd::WeakReference(targetCanvas, pd), pd, false));
+        auto* cnv = tabComponent.openPatch(new pd::Patch(targetReference, pd, false));
 
         Object* found = nullptr;
         for (auto* object : cnv->objects) {
@@ -85,6 +85,9 @@ public:
 
     void renderArea(NVGcontext* nvg, Rectangle<int> area);
 
+    // Parts of the surface that renderArea draws on top of the canvases
+    RectangleList<int> getCanvasOverlayBounds();
+
     bool isActiveWindow() override;
 
     void resized() override;
@@ -202,10 +205,10 @@ private:
     static inline int numEditors = 0;
 
     // Used in plugin
-    std::unique_ptr<MouseRateReducedComponent<ResizableCornerComponent>> cornerResizer;
+    std::unique_ptr<MouseCoalescedComponent<ResizableCornerComponent>> cornerResizer;
 
     // Used in standalone
-    std::unique_ptr<MouseRateReducedComponent<ResizableBorderComponent>> borderResizer;
+    std::unique_ptr<MouseCoalescedComponent<ResizableBorderComponent>> borderResizer;
 
     OSUtils::KeyboardLayout keyboardLayout;
         
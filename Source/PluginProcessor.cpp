@@ -28,6 +28,7 @@
 #include "LookAndFeel.h"
 #include "Object.h"
 #include "Statusbar.h"
+#include "Objects/ImplementationBase.h"
 
 #include "Dialogs/Dialogs.h"
 #include "Dialogs/ConnectionMessageDisplay.h"
@@ -83,7 +84,6 @@ String PluginProcessor::pdlua_version = "pdlua 0.12.0 (lua 5.4)";
 
 PluginProcessor::PluginProcessor()
     : AudioProcessor(buildBusesProperties())
-    , internalSynth(std::make_unique<InternalSynth>())
     , hostInfoUpdater(this)
 {
     // Make sure to use dots for decimal numbers, pd requires that
@@ -95,7 +95,12 @@ PluginProcessor::PluginProcessor()
         LookAndFeel::setDefaultLookAndFeel(&lnf.get());
 
         // Initialise directory structure and settings file
-        initialiseFilesystem();
+        // Checking and repairing the filesystem is slow, and only needs to happen once per process
+        // Processors are constructed while holding the MessageManagerLock, so only one of them can get here at a time
+        if (!filesystemInitialised) {
+            initialiseFilesystem();
+            filesystemInitialised = ProjectInfo::versionDataDir.isDirectory();
+        }
         settingsFile = SettingsFile::getInstance()->initialise();
     }
 
@@ -133,8 +138,10 @@ PluginProcessor::PluginProcessor()
 
     // Set up midi buffers
     midiBufferIn.ensureSize(2048);
+    midiDecodeBuffer.reserve(2048);
     midiBufferOut.ensureSize(2048);
     midiBufferInternalSynth.ensureSize(2048);
+    missedMidiMessages.ensureSize(2048);
 
     atoms_playhead.reserve(3);
     atoms_playhead.resize(1);
@@ -146,16 +153,17 @@ PluginProcessor::PluginProcessor()
 
         settingsFile->setProperty("theme", PlugDataLook::selectedThemes[0]);
         themeName = PlugDataLook::selectedThemes[0];
+        settingsFile->saveSettings();
     }
 
     setTheme(themeName, true);
-    settingsFile->saveSettings();
 
     oversampling = settingsFile->getProperty<int>("oversampling");
 
     setProtectedMode(settingsFile->getProperty<int>("protected"));
     setLimiterThreshold(settingsFile->getProperty<int>("limiter_threshold"));
-    enableInternalSynth = settingsFile->getProperty<int>("internal_synth");
+    setInternalSynthEnabled(settingsFile->getProperty<int>("internal_synth"));
+    setAudioLockGuard(settingsFile->getProperty<bool>("audio_lock_guard"));
 
     auto currentThemeTree = settingsFile->getCurrentTheme();
 
@@ -164,9 +172,9 @@ PluginProcessor::PluginProcessor()
     initialisePd(pdlua_version);
     logMessage(pdlua_version);
 
-    updateSearchPaths();
+    objectImplementations = std::make_unique<ObjectImplementationManager>(this);
 
-    objectLibrary = std::make_unique<pd::Library>(this);
+    updateSearchPaths();
 
     setLatencySamples(pd::Instance::getBlockSize());
     settingsFile->startChangeListener();
@@ -178,12 +186,30 @@ PluginProcessor::~PluginProcessor()
 {
     // Deleting the pd instance in ~PdInstance() will also free all the Pd patches
     patches.clear();
+
+    // Make sure object implementations get deallocated before the pd instance gets deleted
+    objectImplementations.reset(nullptr);
+}
+
+void PluginProcessor::updateObjectImplementations()
+{
+    objectImplementations->updateObjectImplementations();
+}
+
+void PluginProcessor::clearObjectImplementationsForPatch(pd::Patch* p)
+{
+    if (auto patch = p->getPointer()) {
+        objectImplementations->clearObjectImplementationsForPatch(patch.get());
+    }
 }
 
 void PluginProcessor::flushMessageQueue()
 {
     setThis();
     messageDispatcher->dequeueMessages();
+
+    if (audioLockGuard)
+        reportMissedBlocks();
 }
 
 void PluginProcessor::initialiseFilesystem()
@@ -247,7 +273,7 @@ void PluginProcessor::initialiseFilesystem()
         tempVersionDataDir.moveFileTo(versionDataDir);
 
         if (versionDataDir.isDirectory())
-            internalSynth->extractSoundfont();
+            InternalSynth::extractSoundfont();
     }
     if (!deken.exists()) {
         deken.createDirectory();
@@ -494,8 +520,8 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 
     oversampler->initProcessing(samplesPerBlock);
 
-    if (enableInternalSynth && ProjectInfo::isStandalone) {
-        internalSynth->prepare(sampleRate, samplesPerBlock, maxChannels);
+    if (auto* synth = activeInternalSynth.load(); synth && enableInternalSynth) {
+        synth->prepare(sampleRate, samplesPerBlock, maxChannels);
     }
 
     audioAdvancement = 0;
@@ -535,6 +561,10 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     limiter.prepare({ sampleRate, static_cast<uint32>(samplesPerBlock), std::max(1u, static_cast<uint32>(maxChannels)) });
 
     smoothedGain.reset(AudioProcessor::getSampleRate(), 0.02);
+
+    lastOutputBuffer.setSize(std::max(1, maxChannels), samplesPerBlock);
+    lastOutputBuffer.clear();
+    lastOutputGain = 1.0f;
 }
 
 void PluginProcessor::releaseResources()
@@ -584,11 +614,18 @@ bool PluginProcessor::isBusesLayoutSupported(BusesLayout const& layouts) const
 
 static bool hasRealEvents(MidiBuffer& buffer)
 {
-
     return std::any_of(buffer.begin(), buffer.end(),
         [](auto const& event) {
-            int dummy;
-            return !MidiDeviceManager::convertFromSysExFormat(event.getMessage(), dummy).isSysEx();
+            if (event.numBytes < 1 || event.data[0] != 0xf0)
+                return true;
+
+            if (!ProjectInfo::isStandalone || event.numBytes < 4)
+                return false;
+
+            // In the standalone, every event is wrapped in sysex, so we only decode the first byte of the original message
+            uint16_t firstValue;
+            std::memcpy(&firstValue, event.data + 1, sizeof(uint16_t));
+            return (firstValue >> 1) != 0xF0;
         });
 }
 
@@ -602,6 +639,73 @@ void PluginProcessor::settingsFileReloaded()
     updateSearchPaths();
     if (objectLibrary)
         objectLibrary->updateLibrary();
+
+    setAudioLockGuard(settingsFile->getProperty<bool>("audio_lock_guard"));
+}
+
+void PluginProcessor::propertyChanged(String const& name, var const& value)
+{
+    if (name == "audio_lock_guard")
+        setAudioLockGuard(static_cast<bool>(value));
+}
+
+void PluginProcessor::setInternalSynthEnabled(bool const enabled)
+{
+    // The synth is only available in the standalone, so there's no need to create it before it's used
+    if (enabled && ProjectInfo::isStandalone && !internalSynth) {
+        internalSynth = std::make_unique<InternalSynth>();
+        activeInternalSynth = internalSynth.get();
+    }
+
+    enableInternalSynth = enabled;
+}
+
+void PluginProcessor::setAudioLockGuard(bool const enabled)
+{
+    audioLockGuard = enabled;
+
+    // We only need to know who holds the lock for long when we're going to do something about it
+    lockTelemetry.enabled = enabled;
+}
+
+void PluginProcessor::fadeOutLastOutput(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    auto const numSamples = std::min(buffer.getNumSamples(), lastOutputBuffer.getNumSamples());
+    for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
+        buffer.clear(ch, 0, buffer.getNumSamples());
+        if (ch < lastOutputBuffer.getNumChannels() && lastOutputGain > 0.0f)
+            buffer.addFromWithRamp(ch, 0, lastOutputBuffer.getReadPointer(ch), numSamples, lastOutputGain, 0.0f);
+    }
+
+    lastOutputGain = 0.0f;
+
+    // pd didn't see this block's MIDI, so it's kept for the next block that gets the lock
+    // The events are late by then anyway, so they all go at the start of that block
+    for (auto const event : midiMessages) {
+        missedMidiMessages.addEvent(event.data, event.numBytes, 0);
+    }
+    midiMessages.clear();
+}
+
+void PluginProcessor::reportMissedBlocks()
+{
+    auto const missedBlocks = numMissedBlocks.load();
+    if (missedBlocks < lastReportedMissedBlocks)
+        lastReportedMissedBlocks = 0;
+
+    // Don't flood the console while the editor keeps holding the lock
+    auto const currentTime = Time::getMillisecondCounter();
+    if (missedBlocks == lastReportedMissedBlocks || currentTime - lastMissedBlocksReportTime < 5000)
+        return;
+
+    logWarning("Audio skipped " + String(missedBlocks - lastReportedMissedBlocks) + " blocks while the editor held the pd lock. Longest holds:");
+    for (auto const& callSite : lockTelemetry.getLongestHolds(3)) {
+        logWarning("    " + LockTelemetry::toString(callSite));
+    }
+
+    lockTelemetry.reset();
+    lastReportedMissedBlocks = missedBlocks;
+    lastMissedBlocksReportTime = currentTime;
 }
 
 void PluginProcessor::processBlockBypassed(AudioBuffer<float>& buffer, MidiBuffer& midiBuffer)
@@ -624,6 +728,29 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiM
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     setThis();
+
+    // We hold the lock for the whole block, so the locks that pd takes while processing never have to wait
+    auto const useLockGuard = audioLockGuard.load();
+    if (useLockGuard) {
+        auto const deadline = 250.0 * buffer.getNumSamples() / getSampleRate(); // A quarter of the block
+        if (!tryLockAudioThread(deadline)) {
+            numMissedBlocks++;
+            fadeOutLastOutput(buffer, midiMessages);
+            return;
+        }
+    }
+
+    if (!missedMidiMessages.isEmpty()) {
+        missedMidiMessages.addEvents(midiMessages, 0, -1, 0);
+        midiMessages.swapWith(missedMidiMessages);
+        missedMidiMessages.clear();
+    }
+
+    if (ProjectInfo::isStandalone) {
+        if (auto* midiDeviceManager = ProjectInfo::getMidiDeviceManager())
+            midiDeviceManager->dequeueMidiInput(midiMessages, buffer.getNumSamples(), getSampleRate());
+    }
+
     sendPlayhead();
     sendParameters();
 
@@ -645,6 +772,9 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiM
         processConstant(blockOut, midiMessages);
     }
 
+    if (useLockGuard)
+        unlockAudioThread();
+
     auto hasMidiOutEvents = hasRealEvents(midiMessages);
 
     if (oversampling > 0) {
@@ -702,12 +832,14 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiM
         }
 
         // If the internalSynth is enabled and loaded, let it process the midi
-        if (enableInternalSynth && internalSynth->isReady()) {
-            internalSynth->process(buffer, midiBufferInternalSynth);
-        } else if (!enableInternalSynth && internalSynth->isReady()) {
-            internalSynth->unprepare();
-        } else if (enableInternalSynth && !internalSynth->isReady()) {
-            internalSynth->prepare(getSampleRate(), AudioProcessor::getBlockSize(), std::max(totalNumInputChannels, totalNumOutputChannels));
+        if (auto* synth = activeInternalSynth.load()) {
+            if (enableInternalSynth && synth->isReady()) {
+                synth->process(buffer, midiBufferInternalSynth);
+            } else if (!enableInternalSynth && synth->isReady()) {
+                synth->unprepare();
+            } else if (enableInternalSynth && !synth->isReady()) {
+                synth->prepare(getSampleRate(), AudioProcessor::getBlockSize(), std::max(totalNumInputChannels, totalNumOutputChannels));
+            }
         }
         midiBufferInternalSynth.clear();
     }
@@ -727,6 +859,19 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiM
         auto block = dsp::AudioBlock<float>(buffer);
         limiter.process(block);
     }
+
+    if (useLockGuard) {
+        // Fade back in after missed blocks
+        if (lastOutputGain < 1.0f) {
+            buffer.applyGainRamp(0, buffer.getNumSamples(), lastOutputGain, 1.0f);
+            lastOutputGain = 1.0f;
+        }
+
+        auto const numSamples = std::min(buffer.getNumSamples(), lastOutputBuffer.getNumSamples());
+        for (int ch = 0; ch < std::min(buffer.getNumChannels(), lastOutputBuffer.getNumChannels()); ch++) {
+            lastOutputBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+        }
+    }
 }
 
 void PluginProcessor::updatePatchUndoRedoState()
@@ -770,7 +915,7 @@ void PluginProcessor::processConstant(dsp::AudioBlock<float> buffer, MidiBuffer&
         setThis();
 
         midiBufferIn.clear();
-        midiBufferIn.addEvents(midiMessages, audioAdvancement, blockSize, 0);
+        midiBufferIn.addEvents(midiMessages, audioAdvancement, blockSize, -audioAdvancement);
         sendMidiBuffer();
 
         // Process audio
@@ -947,44 +1092,20 @@ void PluginProcessor::sendParameters()
 
 void PluginProcessor::sendMidiBuffer()
 {
-    if (acceptsMidi()) {
-        for (auto const& event : midiBufferIn) {
-
-            int device;
-            auto message = MidiDeviceManager::convertFromSysExFormat(event.getMessage(), device);
-
-            auto channel = message.getChannel() + (device << 4);
-
-            if (message.isNoteOn()) {
-                sendNoteOn(channel, message.getNoteNumber(), message.getVelocity());
-            } else if (message.isNoteOff()) {
-                sendNoteOn(channel, message.getNoteNumber(), 0);
-            } else if (message.isController()) {
-                sendControlChange(channel, message.getControllerNumber(), message.getControllerValue());
-            } else if (message.isPitchWheel()) {
-                sendPitchBend(channel, message.getPitchWheelValue() - 8192);
-            } else if (message.isChannelPressure()) {
-                sendAfterTouch(channel, message.getChannelPressureValue());
-            } else if (message.isAftertouch()) {
-                sendPolyAfterTouch(channel, message.getNoteNumber(), message.getAfterTouchValue());
-            } else if (message.isProgramChange()) {
-                sendProgramChange(channel, message.getProgramChangeNumber());
-            } else if (message.isSysEx()) {
-                for (int i = 0; i < message.getSysExDataSize(); ++i) {
-                    sendSysEx(device, static_cast<int>(message.getSysExData()[i]));
-                }
-            } else if (message.isMidiClock() || message.isMidiStart() || message.isMidiStop() || message.isMidiContinue() || message.isActiveSense() || (message.getRawDataSize() == 1 && message.getRawData()[0] == 0xff)) {
-                for (int i = 0; i < message.getRawDataSize(); ++i) {
-                    sendSysRealTime(device, static_cast<int>(message.getRawData()[i]));
-                }
-            }
-
-            for (int i = 0; i < message.getRawDataSize(); i++) {
-                sendMidiByte(device, static_cast<int>(message.getRawData()[i]));
+    // Sample positions in midiBufferIn are relative to the start of the pd block
+    auto const receivers = getMidiReceivers();
+    if (acceptsMidi() && receivers.any()) {
+        for (auto const event : midiBufferIn) {
+            if (ProjectInfo::isStandalone) {
+                int device;
+                MidiDeviceManager::convertFromSysExFormat(event.data, event.numBytes, midiDecodeBuffer, device);
+                sendMidiEvent(receivers, midiDecodeBuffer.data(), static_cast<int>(midiDecodeBuffer.size()), device, event.samplePosition);
+            } else {
+                sendMidiEvent(receivers, event.data, event.numBytes, 0, event.samplePosition);
             }
         }
-        midiBufferIn.clear();
     }
+    midiBufferIn.clear();
 }
 
 bool PluginProcessor::hasEditor() const
@@ -992,8 +1113,18 @@ bool PluginProcessor::hasEditor() const
     return true; // (change this to false if you choose to not supply an editor)
 }
 
+// The object library is only used by the editor, and indexing it is expensive
+// We wait until an editor opens, so that plugin scans and loading projects with many instances stay fast
+void PluginProcessor::initialiseEditorSubsystems()
+{
+    if (!objectLibrary)
+        objectLibrary = std::make_unique<pd::Library>(this);
+}
+
 AudioProcessorEditor* PluginProcessor::createEditor()
 {
+    initialiseEditorSubsystems();
+
     auto* editor = new PluginEditor(*this);
     setThis();
 
@@ -1068,6 +1199,7 @@ void PluginProcessor::getStateInformation(MemoryBlock& destData)
 
     xml.addChildElement(patchesTree);
 
+    // Older versions only know the PARAM elements, so keep writing them
     PlugDataParameter::saveStateInformation(xml, getParameters());
 
     // store additional extra-data in DAW session if they exist.
@@ -1085,6 +1217,10 @@ void PluginProcessor::getStateInformation(MemoryBlock& destData)
     ostream.writeInt(static_cast<int>(xmlBlock.getSize()));
     ostream.write(xmlBlock.getData(), xmlBlock.getSize());
 
+    // Parameters are also stored as a binary chunk after the xml, which is what this version loads from
+    // Older versions stop reading after the xml, and use the PARAM elements above instead
+    PlugDataParameter::saveStateInformation(ostream, getParameters());
+
     // then detach extraData XmlElement from temporary tree xml for later re-use
     if (extraDataStored) {
         xml.removeChildElement(extraData.get(), false);
@@ -1098,27 +1234,9 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
 
     MemoryInputStream istream(data, sizeInBytes, false);
 
-    lockAudioThread();
-
-    setThis();
-    
-    patches.clear();
-
-    std::vector<pd::WeakReference> openedPatches;
-    // Close all patches
-    for (auto* cnv = pd_getcanvaslist(); cnv; cnv = cnv->gl_next) {
-        openedPatches.push_back(pd::WeakReference(cnv, this));
-    }
-    for(auto patch : openedPatches)
-    {
-        if(auto cnv = patch.get<t_glist*>()) {
-            libpd_closefile(cnv.get());
-        }
-    }
-    
     int numPatches = istream.readInt();
 
-    Array<std::pair<String, File>> patches;
+    Array<std::pair<String, File>> legacyPatches;
 
     for (int i = 0; i < numPatches; i++) {
         auto state = istream.readString();
@@ -1126,7 +1244,7 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
 
         auto presetDir = ProjectInfo::appDataDir.getChildFile("Extra").getChildFile("Presets");
         path = path.replace("${PRESET_DIR}", presetDir.getFullPathName());
-        patches.add({ state, File(path) });
+        legacyPatches.add({ state, File(path) });
     }
 
     auto legacyLatency = istream.readInt();
@@ -1140,34 +1258,21 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
 
     std::unique_ptr<XmlElement> xmlState(getXmlFromBinary(xmlData, xmlSize));
 
-    auto openPatch = [this](String const& content, File const& location, bool pluginMode = false, int splitIndex = 0) {
-        // CHANGED IN v0.9.0:
-        // We now prefer loading the patch content over the patch file, if possible
-        // This generally makes it work more like the users expect, but before we couldn't get it to load abstractions (this is now fixed)
-        if (content.isNotEmpty()) {
-            auto locationIsValid = location.getParentDirectory().exists() && location.getFullPathName().isNotEmpty();
-            // Force pd to use this path for the next opened patch
-            // This makes sure the patch can find abstractions/resources, even though it's loading a patch from state
-            if(locationIsValid) {
-                glob_forcefilename(generateSymbol(location.getFileName().toRawUTF8()), generateSymbol(location.getParentDirectory().getFullPathName().replaceCharacter('\\', '/').toRawUTF8()));
-            }
-            
-            auto patchPtr = loadPatch(content);
-            patchPtr->splitViewIndex = splitIndex;
-            patchPtr->openInPluginMode = pluginMode;
-            if (!locationIsValid || location.getParentDirectory() == File::getSpecialLocation(File::tempDirectory)) {
-                patchPtr->setUntitled();
-            } else {
-                patchPtr->setCurrentFile(URL(location));
-                patchPtr->setTitle(location.getFileName());
-            }
-        } else {
-            auto patchPtr = loadPatch(URL(location));
-            patchPtr->splitViewIndex = splitIndex;
-            patchPtr->openInPluginMode = pluginMode;
-        }
+    // Sessions saved before the binary parameter chunk have their parameters inside the xml
+    MemoryBlock parameterState;
+    if (istream.getNumBytesRemaining() > 0) {
+        istream.readIntoMemoryBlock(parameterState);
+    }
+
+    struct PatchViewState {
+        bool pluginMode = false;
+        int splitIndex = 0;
     };
 
+    std::vector<pd::PatchLoader::Source> patchSources;
+    std::vector<PatchViewState> patchViewStates;
+    auto const usePatchCache = settingsFile->getProperty<bool>("patch_cache");
+
     if (xmlState) {
         // If xmltree contains new patch format, use that
         if (auto* patchTree = xmlState->getChildByName("Patches")) {
@@ -1184,19 +1289,87 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
                 auto presetDir = ProjectInfo::versionDataDir.getChildFile("Extra").getChildFile("Presets");
                 location = location.replace("${PRESET_DIR}", presetDir.getFullPathName());
 
-                openPatch(content, location, pluginMode, splitIndex);
+                patchSources.push_back({ content, File(location), usePatchCache });
+                patchViewStates.push_back({ pluginMode, splitIndex });
             }
         }
         // Otherwise, load from legacy format
         else {
-            for (auto& [content, location] : patches) {
-                openPatch(content, location);
+            for (auto& [content, location] : legacyPatches) {
+                patchSources.push_back({ content, location, usePatchCache });
+                patchViewStates.push_back({});
             }
         }
+    }
 
-        jassert(xmlState);
+    // Reading patch files, decoding and writing patch caches doesn't need the lock, so we do that before taking it, see PatchLoader
+    // Only turning them into pd canvases has to happen with the lock held
+    auto preparedPatches = preparePatches(patchSources);
 
-        PlugDataParameter::loadStateInformation(*xmlState, getParameters());
+    lockAudioThread();
+
+    setThis();
+    
+    patches.clear();
+
+    std::vector<pd::WeakReference> openedPatches;
+    // Close all patches
+    for (auto* cnv = pd_getcanvaslist(); cnv; cnv = cnv->gl_next) {
+        openedPatches.push_back(pd::WeakReference(cnv, this));
+    }
+    for(auto patch : openedPatches)
+    {
+        if(auto cnv = patch.get<t_glist*>()) {
+            libpd_closefile(cnv.get());
+        }
+    }
+    
+    for (size_t i = 0; i < patchSources.size(); i++) {
+        auto const& [content, location, useCache] = patchSources[i];
+
+        // Max patches, and files on iOS, go through the regular load path, see PatchLoader::canPrepare()
+        if (!pd::PatchLoader::canPrepare(patchSources[i])) {
+            if (auto patchPtr = loadPatch(URL(location))) {
+                patchPtr->splitViewIndex = patchViewStates[i].splitIndex;
+                patchPtr->openInPluginMode = patchViewStates[i].pluginMode;
+            }
+            continue;
+        }
+
+        // CHANGED IN v0.9.0:
+        // We now prefer loading the patch content over the patch file, if possible
+        // This generally makes it work more like the users expect, but before we couldn't get it to load abstractions (this is now fixed)
+        // The location is still used to resolve abstractions and resources, even though the patch is loaded from state
+        auto patchPtr = openPatch(preparedPatches[i]);
+        if (!patchPtr->getPointer()) {
+            logError("Couldn't open patch");
+            continue;
+        }
+
+        patches.add(patchPtr);
+        patchPtr->splitViewIndex = patchViewStates[i].splitIndex;
+        patchPtr->openInPluginMode = patchViewStates[i].pluginMode;
+
+        if (content.isNotEmpty()) {
+            auto locationIsValid = location.getParentDirectory().exists() && location.getFullPathName().isNotEmpty();
+            if (!locationIsValid || location.getParentDirectory() == File::getSpecialLocation(File::tempDirectory)) {
+                patchPtr->setUntitled();
+            } else {
+                patchPtr->setCurrentFile(URL(location));
+                patchPtr->setTitle(location.getFileName());
+            }
+        } else {
+            patchPtr->setCurrentFile(URL(location));
+        }
+    }
+
+    MemoryInputStream parameterStream(parameterState, false);
+    auto const loadedParameters = !parameterState.isEmpty() && PlugDataParameter::loadStateInformation(parameterStream, getParameters());
+
+    if (xmlState) {
+        if (!loadedParameters) {
+            PlugDataParameter::loadStateInformation(*xmlState, getParameters());
+        }
 
         auto versionString = String("0.6.1"); // latest version that didn't have version inside the daw state
 
@@ -1252,9 +1425,9 @@ pd::Patch::Ptr PluginProcessor::loadPatch(URL const& patchURL)
 {
     auto patchFile = patchURL.getLocalFile();
 
+#if JUCE_IOS
     lockAudioThread();
 
-#if JUCE_IOS
     auto tempFile = File::createTempFile(".pd");
     auto patchContent = patchFile.loadFileAsString();
 
@@ -1274,10 +1447,12 @@ pd::Patch::Ptr PluginProcessor::loadPatch(URL const& patchURL)
             newPatch->setCurrentFile(patchURL);
         }
     }
+
+    unlockAudioThread();
 #else
-    auto newPatch = openPatch(patchFile);
+    // This takes the audio lock itself, so reading the patch and its cache doesn't block audio
+    auto newPatch = openPatch(patchFile, settingsFile->getProperty<bool>("patch_cache"));
 #endif
-    unlockAudioThread();
 
     if (!newPatch->getPointer()) {
         logError("Couldn't open patch");
@@ -1539,6 +1714,86 @@ void PluginProcessor::receiveSysMessage(String const& selector, std::vector<pd::
     }
 }
 
+void PluginProcessor::createPanel(int type, char const* snd, char const* location, char const* callbackName, int openMode)
+{
+    auto* obj = generateSymbol(snd)->s_thing;
+
+    auto defaultFile = File(location);
+    if (!defaultFile.exists()) {
+        defaultFile = SettingsFile::getInstance()->getLastBrowserPathForId("openpanel");
+        if (!defaultFile.exists())
+            defaultFile = ProjectInfo::appDataDir;
+    }
+
+    if (type) {
+        MessageManager::callAsync(
+            [this, obj, defaultFile, openMode, callback = String(callbackName)]() mutable {
+                FileBrowserComponent::FileChooserFlags folderChooserFlags;
+
+                if (openMode <= 0) {
+                    folderChooserFlags = static_cast<FileBrowserComponent::FileChooserFlags>(FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles);
+                } else if (openMode == 1) {
+                    folderChooserFlags = static_cast<FileBrowserComponent::FileChooserFlags>(FileBrowserComponent::openMode | FileBrowserComponent::canSelectDirectories);
+                } else {
+                    folderChooserFlags = static_cast<FileBrowserComponent::FileChooserFlags>(FileBrowserComponent::openMode | FileBrowserComponent::canSelectDirectories | FileBrowserComponent::canSelectFiles | FileBrowserComponent::canSelectMultipleItems);
+                }
+
+                static std::unique_ptr<FileChooser> openChooser;
+                openChooser = std::make_unique<FileChooser>("Open...", defaultFile, "", SettingsFile::getInstance()->wantsNativeDialog());
+                openChooser->launchAsync(folderChooserFlags, [this, obj, callback](FileChooser const& fileChooser) {
+                    auto const files = fileChooser.getResults();
+                    if (files.isEmpty())
+                        return;
+
+                    auto parentDirectory = files.getFirst().getParentDirectory();
+                    SettingsFile::getInstance()->setLastBrowserPathForId("openpanel", parentDirectory);
+
+                    lockAudioThread();
+
+                    std::vector<t_atom> atoms(files.size());
+
+                    for (int i = 0; i < atoms.size(); i++) {
+                        String pathname = files[i].getFullPathName();
+
+                    // Convert slashes to backslashes
+#if JUCE_WINDOWS
+                        pathname = pathname.replaceCharacter('\\', '/');
+#endif
+
+                        libpd_set_symbol(atoms.data() + i, pathname.toRawUTF8());
+                    }
+
+                    pd_typedmess(obj, generateSymbol(callback), atoms.size(), atoms.data());
+
+                    unlockAudioThread();
+                });
+            });
+    } else {
+        MessageManager::callAsync(
+            [this, obj, defaultFile, callback = String(callbackName)]() mutable {
+
+#if JUCE_IOS
+                Component* dialogParent = getActiveEditor();
+#else
+                Component* dialogParent = nullptr;
+#endif
+
+                Dialogs::showSaveDialog([this, obj, callback](URL result) {
+                    auto pathName = result.getLocalFile().getFullPathName();
+                    const auto* path = pathName.toRawUTF8();
+
+                    t_atom argv[1];
+                    libpd_set_symbol(argv, path);
+
+                    lockAudioThread();
+                    pd_typedmess(obj, generateSymbol(callback), 1, argv);
+                    unlockAudioThread();
+                },
+                    "", "openpanel", dialogParent);
+            });
+    }
+}
+
 void PluginProcessor::addTextToTextEditor(unsigned long ptr, String text)
 {
     Dialogs::appendTextToTextEditorDialog(textEditorDialogs[ptr].get(), text);
@@ -1822,6 +2077,35 @@ void PluginProcessor::updateConsole(int numMessages, bool newWarning)
     }
 }
 
+NamedValueSet PluginProcessor::getMemoryUsage()
+{
+    auto usage = Instance::getMemoryUsage();
+
+    auto audioBufferMemory = (audioVectorIn.capacity() + audioVectorOut.capacity()) * sizeof(float);
+    for (auto* audioBuffer : { &audioBufferIn, &audioBufferOut, &bypassBuffer }) {
+        audioBufferMemory += static_cast<size_t>(audioBuffer->getNumChannels() * audioBuffer->getNumSamples()) * sizeof(float);
+    }
+    for (auto* fifo : { inputFifo.get(), outputFifo.get() }) {
+        if (fifo)
+            audioBufferMemory += fifo->getMemoryUsage();
+    }
+    usage.set("audio_buffers", static_cast<int64>(audioBufferMemory));
+
+    size_t midiBufferMemory = 0;
+    for (auto* midiBuffer : { &midiBufferIn, &midiBufferOut, &midiBufferInternalSynth }) {
+        midiBufferMemory += static_cast<size_t>(midiBuffer->data.capacity());
+    }
+    usage.set("midi_buffers", static_cast<int64>(midiBufferMemory));
+
+    if (statusbarSource)
+        usage.set("statusbar", static_cast<int64>(statusbarSource->peakBuffer.getMemoryUsage()));
+
+    if (objectLibrary)
+        usage.set("library", static_cast<int64>(objectLibrary->getMemoryUsage()));
+
+    return usage;
+}
+
 Array<PluginEditor*> PluginProcessor::getEditors() const
 {
     Array<PluginEditor*> editors;
@@ -22,6 +22,7 @@ class Library;
 }
 
 class InternalSynth;
+class ObjectImplementationManager;
 class SettingsFile;
 class StatusbarSource;
 struct PlugDataLook;
@@ -41,6 +42,7 @@ public:
     void setOversampling(int amount);
     void setLimiterThreshold(int amount);
     void setProtectedMode(bool enabled);
+    void setInternalSynthEnabled(bool enabled);
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void numChannelsChanged() override;
     void releaseResources() override;
@@ -87,13 +89,20 @@ public:
     void receiveMidiByte(int port, int byte) override;
     void receiveSysMessage(String const& selector, std::vector<pd::Atom> const& list) override;
 
+    void createPanel(int type, char const* snd, char const* location, char const* callbackName, int openMode = -1) override;
+
     void addTextToTextEditor(unsigned long ptr, String text) override;
     void showTextEditor(unsigned long ptr, Rectangle<int> bounds, String title) override;
 
     void updateConsole(int numMessages, bool newWarning) override;
 
+    NamedValueSet getMemoryUsage() override;
+
     void reloadAbstractions(File changedPatch, t_glist* except) override;
 
+    void updateObjectImplementations() override;
+    void clearObjectImplementationsForPatch(pd::Patch* p) override;
+
     void processConstant(dsp::AudioBlock<float>, MidiBuffer&);
     void processVariable(dsp::AudioBlock<float>, MidiBuffer&);
 
@@ -111,8 +120,11 @@ public:
     void updatePatchUndoRedoState();
 
     void settingsFileReloaded() override;
+    void propertyChanged(String const& name, var const& value) override;
+    void setAudioLockGuard(bool enabled);
 
     void initialiseFilesystem();
+    void initialiseEditorSubsystems();
     void updateSearchPaths();
 
     void sendMidiBuffer();
@@ -160,6 +172,9 @@ public:
     // Just so we never have to deal with deleting the default LnF
     SharedResourcePointer<PlugDataLook> lnf;
 
+    // Shared by all objects, only objects that set colours on their look and feel get one of their own
+    std::unique_ptr<PlugDataLook> objectLnf;
+
     static inline constexpr int numParameters = 512;
     static inline constexpr int numInputBuses = 16;
     static inline constexpr int numOutputBuses = 16;
@@ -170,9 +185,17 @@ public:
     // Zero means no oversampling
     std::atomic<int> oversampling = 0;
 
+    // Only created once the synth is first enabled in the standalone
+    // The audio thread reads it through activeInternalSynth, since it can be created while audio is running
     std::unique_ptr<InternalSynth> internalSynth;
+    std::atomic<InternalSynth*> activeInternalSynth = nullptr;
     std::atomic<bool> enableInternalSynth = false;
 
+    // Contention-aware mode: instead of waiting for the GUI to release the pd lock, the audio thread gives up after a deadline
+    // It then fades out the last block it produced, and counts the block as missed
+    std::atomic<bool> audioLockGuard = false;
+    std::atomic<int> numMissedBlocks = 0;
+
     OwnedArray<PluginEditor> openedEditors;
     Component::SafePointer<ConnectionMessageDisplay> connectionListener;
 
@@ -189,6 +212,19 @@ private:
     AudioBuffer<float> audioBufferOut;
     AudioBuffer<float> bypassBuffer;
 
+    // Last output of the audio lock guard, and how loud it still is after blocks were missed
+    AudioBuffer<float> lastOutputBuffer;
+    float lastOutputGain = 1.0f;
+    void fadeOutLastOutput(AudioBuffer<float>& buffer, MidiBuffer& midiMessages);
+
+    // Host MIDI from missed blocks, delivered in the next block that gets the lock
+    MidiBuffer missedMidiMessages;
+
+    // Logs the missed blocks and the call sites that held the lock longest, at most once every few seconds
+    void reportMissedBlocks();
+    int lastReportedMissedBlocks = 0;
+    uint32 lastMissedBlocksReportTime = 0;
+
     std::vector<float> audioVectorIn;
     std::vector<float> audioVectorOut;
 
@@ -196,6 +232,7 @@ private:
     std::unique_ptr<AudioMidiFifo> outputFifo;
 
     MidiBuffer midiBufferIn;
+    std::vector<uint8> midiDecodeBuffer;
     MidiBuffer midiBufferOut;
     MidiBuffer midiBufferInternalSynth;
 
@@ -214,6 +251,11 @@ private:
 
     std::map<unsigned long, std::unique_ptr<Component>> textEditorDialogs;
 
+    std::unique_ptr<ObjectImplementationManager> objectImplementations;
+
+    // Shared by all instances in this process
+    static inline std::atomic<bool> filesystemInitialised = false;
+
     static inline String const else_version = "ELSE v1.0-rc12";
     static inline String const cyclone_version = "cyclone v0.9-0";
     static inline String const heavylib_version = "heavylib v0.4";
@@ -35,12 +35,12 @@ class AutomationItem : public ObjectDragAndDrop
     PluginProcessor* pd;
 
 public:
-    AutomationItem(PlugDataParameter* parameter, Component* parentComponent, PluginProcessor* processor)
+    // Items are recycled by AutomationComponent as the list scrolls, call setParameter() to show a parameter
+    AutomationItem(Component* parentComponent, PluginProcessor* processor)
         : ObjectDragAndDrop(parentComponent->findParentComponentOfClass<PluginEditor>())
         , pd(processor)
         , rangeProperty("Range", range, false)
         , modeProperty("Mode", mode, { "Float", "Integer", "Logarithmic", "Exponential" })
-        , param(parameter)
     {
         addMouseListener(parentComponent, true);
 
@@ -73,7 +73,7 @@ public:
             rangeProperty.setVisible(toggleState);
             modeProperty.setVisible(toggleState);
 
-            getParentComponent()->resized();
+            onExpand(this, toggleState);
         };
 
         auto& minimumComponent = rangeProperty.getMinimumComponent();
@@ -119,8 +119,6 @@ public:
         slider.setTextBoxStyle(Slider::NoTextBox, false, 45, 13);
 
         if (ProjectInfo::isStandalone) {
-            valueLabel.setText(String(param->getUnscaledValue(), 2), dontSendNotification);
-            slider.setValue(param->getUnscaledValue(), dontSendNotification);
             slider.onValueChange = [this]() mutable {
                 float value = slider.getValue();
                 param->setUnscaledValueNotifyingHost(value);
@@ -131,9 +129,6 @@ public:
                 float value = slider.getValue();
                 valueLabel.setText(String(value, 2), dontSendNotification);
             };
-
-            attachment = std::make_unique<SliderParameterAttachment>(*param, slider, nullptr);
-            valueLabel.setText(String(param->getValue(), 2), dontSendNotification);
         }
 
         valueLabel.onValueChange = [this](float newValue) mutable {
@@ -172,11 +167,6 @@ public:
         };
 
         nameLabel.onEditorHide = [this]() {
-            StringArray allNames;
-            for (auto* param : pd->getParameters()) {
-                allNames.add(dynamic_cast<PlugDataParameter*>(param)->getTitle());
-            }
-
             auto newName = nameLabel.getText(true);
             auto character = newName[0];
 
@@ -184,9 +174,8 @@ public:
             if ((character == '_' || character == '-'
                     || (character >= 'a' && character <= 'z')
                     || (character >= 'A' && character <= 'Z'))
-                && newName.containsOnly("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890_-") && !allNames.contains(newName) && newName.isNotEmpty()) {
-                param->setName(nameLabel.getText(true));
-                param->notifyDAW();
+                && newName.containsOnly("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890_-") && newName.isNotEmpty() && !isNameTaken(newName)) {
+                onRename(this, newName);
             } else {
                 nameLabel.setText(lastName, dontSendNotification);
             }
@@ -202,8 +191,39 @@ public:
 
         addChildComponent(reorderButton);
         addChildComponent(deleteButton);
+    }
+
+    void setParameter(PlugDataParameter* newParameter, bool expanded)
+    {
+        attachment.reset();
+        param = newParameter;
+
+        deleteButton.setVisible(false);
+        reorderButton.setVisible(false);
+
+        settingsButton.setToggleState(expanded, dontSendNotification);
+        rangeProperty.setVisible(expanded);
+        modeProperty.setVisible(expanded);
+
+        if (ProjectInfo::isStandalone) {
+            valueLabel.setText(String(param->getUnscaledValue(), 2), dontSendNotification);
+            slider.setValue(param->getUnscaledValue(), dontSendNotification);
+        } else {
+            attachment = std::make_unique<SliderParameterAttachment>(*param, slider, nullptr);
+            valueLabel.setText(String(param->getValue(), 2), dontSendNotification);
+        }
 
+        resetDragAndDropImage();
         update();
+        resized();
+    }
+
+    // Stops tracking the parameter, so the item can be reused for another row
+    void clearParameter()
+    {
+        attachment.reset();
+        param = nullptr;
+        setVisible(false);
     }
 
     void update()
@@ -313,6 +333,10 @@ public:
 
     void valueChanged(Value& v) override
     {
+        // Value changes are delivered asynchronously, the item might have been recycled since
+        if (!param)
+            return;
+
         if (v.refersToSameSourceAs(range)) {
             auto min = static_cast<float>(range.getValue().getArray()->getReference(0));
             auto max = static_cast<float>(range.getValue().getArray()->getReference(1));
@@ -324,19 +348,9 @@ public:
         }
     }
 
-    int getItemHeight()
-    {
-        if (param->isEnabled()) {
-            return settingsButton.getToggleState() ? 110.0f : 56.0f;
-        } else {
-            return 0.0f;
-        }
-    }
-
-    // TOOD: hides non-virtual function!
-    bool isEnabled() const
+    static int getItemHeight(bool expanded)
     {
-        return param->isEnabled();
+        return expanded ? 110 : 56;
     }
 
     void resized() override
@@ -382,6 +396,9 @@ public:
     }
 
     std::function<void(AutomationItem*)> onDelete = [](AutomationItem*) {};
+    std::function<void(AutomationItem*, bool)> onExpand = [](AutomationItem*, bool) {};
+    std::function<void(AutomationItem*, String const&)> onRename = [](AutomationItem*, String const&) {};
+    std::function<bool(String const&)> isNameTaken = [](String const&) { return false; };
     std::unique_ptr<HostProvidedContextMenu> hostContextMenu;
 
     SmallIconButton deleteButton = SmallIconButton(Icons::Clear);
@@ -403,7 +420,7 @@ public:
 
     ReorderButton reorderButton;
 
-    PlugDataParameter* param;
+    PlugDataParameter* param = nullptr;
 
     std::unique_ptr<SliderParameterAttachment> attachment;
 
@@ -565,25 +582,25 @@ public:
         : pd(processor)
         , parentComponent(parent)
     {
-        updateSliders();
+        updateParameters();
 
         addAndMakeVisible(addParameterButton);
         addAndMakeVisible(draggedItemDropShadow);
 
-        addParameterButton.onClick = [this, parent]() {
+        addParameterButton.onClick = [this]() {
             for (auto* param : getParameters()) {
                 if (!param->isEnabled()) {
                     param->setEnabled(true);
-                    param->setName(getNewParameterName());
+                    renameParameter(param, getNewParameterName(enabledParameterNames));
                     param->setIndex(rows.size());
                     param->notifyDAW();
+                    rows.add(param);
                     break;
                 }
             }
 
-            resized();
-            parent->resized();
-            updateSliders();
+            checkMaxNumParameters();
+            updateLayout();
         };
     }
 
@@ -605,7 +622,7 @@ public:
     {
         if (draggedItem) {
             for (int p = 0; p < rows.size(); p++) {
-                rows[p]->param->setIndex(p);
+                rows[p]->setIndex(p);
             }
             draggedItem = nullptr;
             shouldAnimate = true;
@@ -631,30 +648,28 @@ public:
         draggedItem->setTopLeftPosition(dragPos - accumulatedOffsetY);
         viewportPosY -= autoScrollOffset.getY();
 
-        int idx = rows.indexOf(draggedItem);
-        if (idx > 0 && draggedItem->getBounds().getCentreY() < rows[idx - 1]->getBounds().getCentreY() && rows[idx - 1]->isEnabled()) {
+        auto getRowCentre = [this](int row) {
+            return (rowPositions[row] + rowPositions[row + 1]) / 2;
+        };
+
+        int idx = rows.indexOf(draggedItem->param);
+        auto draggedCentre = draggedItem->getBounds().getCentreY();
+        if (idx > 0 && draggedCentre < getRowCentre(idx - 1)) {
             rows.swap(idx, idx - 1);
             shouldAnimate = true;
             resized();
-        } else if (idx < rows.size() - 1 && draggedItem->getBounds().getCentreY() > rows[idx + 1]->getBounds().getCentreY() && rows[idx + 1]->isEnabled()) {
+        } else if (idx >= 0 && idx < rows.size() - 1 && draggedCentre > getRowCentre(idx + 1)) {
             rows.swap(idx, idx + 1);
             shouldAnimate = true;
             resized();
         }
     }
 
-    String getNewParameterName()
+    static String getNewParameterName(std::unordered_multiset<String> const& takenNames)
     {
-        StringArray takenNames;
-        for (auto* row : rows) {
-            if (row->isEnabled()) {
-                takenNames.add(row->param->getTitle());
-            }
-        }
-
         auto newParamName = String("param");
         int i = 1;
-        while (takenNames.contains(newParamName + String(i))) {
+        while (takenNames.count(newParamName + String(i))) {
             i++;
         }
 
@@ -672,59 +687,89 @@ public:
         return params;
     }
 
-    void updateSliders()
+    // Reads the list of enabled parameters from the processor again, for when they were changed from outside the panel
+    // This only touches the parameters, items are rebound to their rows in resized()
+    void updateParameters()
     {
-        rows.clear();
+        rows.clearQuick();
+        parameterNames.clear();
+        enabledParameterNames.clear();
 
         for (auto* param : getParameters()) {
+            parameterNames.insert(param->getTitle());
             if (param->isEnabled()) {
-                auto* slider = rows.add(new AutomationItem(param, parentComponent, pd));
-                addAndMakeVisible(slider);
-
-                slider->reorderButton.addMouseListener(this, false);
-
-                slider->onDelete = [this](AutomationItem* toDelete) {
-                    StringArray paramNames;
-
-                    for (auto* param : getParameters()) {
-                        if (param != toDelete->param) {
-                            paramNames.add(param->getTitle());
-                        }
-                    }
-
-                    auto toDeleteIdx = rows.indexOf(toDelete);
-                    for (int i = toDeleteIdx; i < rows.size(); i++) {
-                        rows[i]->param->setIndex(rows[i]->param->getIndex() - 1);
-                    }
-
-                    auto newParamName = String("param");
-                    int i = 1;
-                    while (paramNames.contains(newParamName + String(i))) {
-                        i++;
-                    }
-                    newParamName += String(i);
-
-                    toDelete->param->setEnabled(false);
-                    toDelete->param->setName(newParamName);
-                    toDelete->param->setValue(0.0f);
-                    toDelete->param->setRange(0.0f, 1.0f);
-                    toDelete->param->setMode(PlugDataParameter::Float);
-                    toDelete->param->notifyDAW();
-
-                    updateSliders();
-                };
+                rows.add(param);
+                enabledParameterNames.insert(param->getTitle());
             }
         }
 
-        std::sort(rows.begin(), rows.end(), [](auto* a, auto* b) {
-            return a->param->getIndex() < b->param->getIndex();
+        std::stable_sort(rows.begin(), rows.end(), [](auto* a, auto* b) {
+            return a->getIndex() < b->getIndex();
         });
 
-        addParameterButton.toFront(false);
+        for (auto it = expandedParameters.begin(); it != expandedParameters.end();) {
+            it = (*it)->isEnabled() ? std::next(it) : expandedParameters.erase(it);
+        }
+
+        for (auto* item : items) {
+            if (item->param && item->param->isEnabled()) {
+                item->update();
+            } else if (item->param) {
+                item->clearParameter();
+            }
+        }
 
         checkMaxNumParameters();
-        parentComponent->resized();
-        resized();
+        updateLayout();
+    }
+
+    void deleteParameter(PlugDataParameter* param)
+    {
+        auto toDeleteIdx = rows.indexOf(param);
+        if (toDeleteIdx < 0)
+            return;
+
+        rows.remove(toDeleteIdx);
+        for (int i = toDeleteIdx; i < rows.size(); i++) {
+            rows[i]->setIndex(rows[i]->getIndex() - 1);
+        }
+
+        removeName(enabledParameterNames, param->getTitle());
+        expandedParameters.erase(param);
+
+        removeName(parameterNames, param->getTitle());
+        auto newParamName = getNewParameterName(parameterNames);
+        parameterNames.insert(param->getTitle());
+
+        param->setEnabled(false);
+        renameParameter(param, newParamName);
+        param->setValue(0.0f);
+        param->setRange(0.0f, 1.0f);
+        param->setMode(PlugDataParameter::Float);
+        param->notifyDAW();
+
+        checkMaxNumParameters();
+        updateLayout();
+    }
+
+    void renameParameter(PlugDataParameter* param, String const& newName)
+    {
+        removeName(parameterNames, param->getTitle());
+        parameterNames.insert(newName);
+
+        if (param->isEnabled()) {
+            removeName(enabledParameterNames, param->getTitle());
+            enabledParameterNames.insert(newName);
+        }
+
+        param->setName(newName);
+    }
+
+    // Removes a single occurrence, since disabled parameters can share a name with an enabled one
+    static void removeName(std::unordered_multiset<String>& names, String const& name)
+    {
+        if (auto it = names.find(name); it != names.end())
+            names.erase(it);
     }
 
     void checkMaxNumParameters()
@@ -732,35 +777,142 @@ public:
         addParameterButton.setVisible(rows.size() < PluginProcessor::numParameters);
     }
 
+    void updateLayout()
+    {
+        parentComponent->resized();
+        resized();
+    }
+
     void resized() override
     {
-        auto& animator = Desktop::getInstance().getAnimator();
+        rowPositions.resize(rows.size() + 1);
+        rowPositions[0] = 2;
+        for (int p = 0; p < rows.size(); p++) {
+            rowPositions[p + 1] = rowPositions[p] + AutomationItem::getItemHeight(expandedParameters.count(rows[p]));
+        }
+
+        updateVisibleItems();
+
+        shouldAnimate = false;
+        addParameterButton.setBounds(0, rowPositions.back(), getWidth(), 28);
+    }
+
+    // Makes sure only the rows inside the viewport have an item, and moves the items to their rows
+    void updateVisibleItems()
+    {
+        if (rowPositions.size() != rows.size() + 1)
+            return;
+
+        auto visibleArea = Rectangle<int>();
+        if (auto* viewport = findParentComponentOfClass<BouncingViewport>()) {
+            visibleArea = viewport->getViewArea();
+        }
+
+        auto firstRow = static_cast<int>(std::upper_bound(rowPositions.begin(), rowPositions.end() - 1, visibleArea.getY()) - rowPositions.begin()) - 1;
+        firstRow = std::max(firstRow, 0);
 
-        int y = 2;
+        auto lastRow = firstRow;
+        while (lastRow < rows.size() && rowPositions[lastRow] < visibleArea.getBottom()) {
+            lastRow++;
+        }
+
+        auto isVisibleRow = [this, firstRow, lastRow](PlugDataParameter* param) {
+            for (int row = firstRow; row < lastRow; row++) {
+                if (rows[row] == param)
+                    return true;
+            }
+            return false;
+        };
+
+        for (auto* item : items) {
+            if (item->param && item != draggedItem && !isVisibleRow(item->param)) {
+                item->clearParameter();
+            }
+        }
+
+        auto& animator = Desktop::getInstance().getAnimator();
         int width = getWidth();
-        for (int p = 0; p < rows.size(); p++) {
-            int height = rows[p]->getItemHeight();
-            if (rows[p] != draggedItem) {
-                auto bounds = Rectangle<int>(0, y, width, height);
-                if (shouldAnimate) {
-                    animator.animateComponent(rows[p], bounds, 1.0f, 200, false, 3.0f, 0.0f);
-                } else {
-                    animator.cancelAnimation(rows[p], false);
-                    rows[p]->setBounds(bounds);
-                }
+        for (int row = firstRow; row < lastRow; row++) {
+            auto* param = rows[row];
+            auto bounds = Rectangle<int>(0, rowPositions[row], width, rowPositions[row + 1] - rowPositions[row]);
+
+            auto* item = getItemForParameter(param);
+            if (item && item == draggedItem)
+                continue;
+
+            if (item && shouldAnimate) {
+                animator.animateComponent(item, bounds, 1.0f, 200, false, 3.0f, 0.0f);
+                continue;
             }
-            y += height;
+
+            if (!item) {
+                item = getUnusedItem();
+                item->setParameter(param, expandedParameters.count(param));
+                item->setVisible(true);
+            }
+
+            animator.cancelAnimation(item, false);
+            item->setBounds(bounds);
         }
 
-        shouldAnimate = false;
-        addParameterButton.setBounds(0, y, getWidth(), 28);
+        addParameterButton.toFront(false);
+        if (draggedItem) {
+            draggedItem->toFront(false);
+        }
+    }
+
+    AutomationItem* getItemForParameter(PlugDataParameter* param)
+    {
+        for (auto* item : items) {
+            if (item->param == param)
+                return item;
+        }
+
+        return nullptr;
+    }
+
+    AutomationItem* getUnusedItem()
+    {
+        for (auto* item : items) {
+            if (!item->param)
+                return item;
+        }
+
+        auto* item = items.add(new AutomationItem(parentComponent, pd));
+        addChildComponent(item);
+
+        item->reorderButton.addMouseListener(this, false);
+
+        item->onDelete = [this](AutomationItem* toDelete) {
+            deleteParameter(toDelete->param);
+        };
+
+        item->onExpand = [this](AutomationItem* expandedItem, bool expanded) {
+            if (expanded) {
+                expandedParameters.insert(expandedItem->param);
+            } else {
+                expandedParameters.erase(expandedItem->param);
+            }
+            updateLayout();
+        };
+
+        item->onRename = [this](AutomationItem* renamedItem, String const& newName) {
+            renameParameter(renamedItem->param, newName);
+            renamedItem->param->notifyDAW();
+        };
+
+        item->isNameTaken = [this](String const& name) {
+            return parameterNames.count(name) > 0;
+        };
+
+        return item;
     }
 
     int getTotalHeight() const
     {
         int y = 30;
-        for (int p = 0; p < rows.size(); p++) {
-            y += rows[p]->getItemHeight();
+        for (auto* param : rows) {
+            y += AutomationItem::getItemHeight(expandedParameters.count(param));
         }
 
         return y;
@@ -776,7 +928,17 @@ public:
 
     PluginProcessor* pd;
     Component* parentComponent;
-    OwnedArray<AutomationItem> rows;
+
+    // Enabled parameters in display order, and the top of each row
+    Array<PlugDataParameter*> rows;
+    std::vector<int> rowPositions;
+
+    std::unordered_set<PlugDataParameter*> expandedParameters;
+    std::unordered_multiset<String> parameterNames;
+    std::unordered_multiset<String> enabledParameterNames;
+
+    // Only as many items as fit in the viewport, they're reused for other rows when scrolling
+    OwnedArray<AutomationItem> items;
     AddParameterButton addParameterButton;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AutomationComponent)
@@ -804,6 +966,7 @@ public:
 
     void scrollBarMoved(ScrollBar* scrollBarThatHasMoved, double newRangeStart) override
     {
+        sliders.updateVisibleItems();
         repaint();
     }
 
@@ -818,23 +981,22 @@ public:
         viewport.setBounds(getLocalBounds());
 
         sliders.setSize(getWidth(), std::max(sliders.getTotalHeight(), viewport.getMaximumVisibleHeight()));
+        sliders.updateVisibleItems();
     }
 
     void updateParameterValue(PlugDataParameter* changedParameter)
     {
-        for (int p = 0; p < sliders.rows.size(); p++) {
-            auto* param = sliders.rows[p]->param;
-            auto& slider = sliders.rows[p]->slider;
-            if (changedParameter == param && slider.getThumbBeingDragged() == -1) {
-                slider.setValue(param->getUnscaledValue());
-                break;
+        // Parameters that are scrolled out of view don't have an item, they'll read their value when they come into view
+        if (auto* item = sliders.getItemForParameter(changedParameter)) {
+            if (item->slider.getThumbBeingDragged() == -1) {
+                item->slider.setValue(changedParameter->getUnscaledValue());
             }
         }
     }
 
     void handleAsyncUpdate() override
     {
-        sliders.updateSliders();
+        sliders.updateParameters();
     }
     BouncingViewport viewport;
     AutomationComponent sliders;
@@ -38,10 +38,16 @@ InternalSynth::~InternalSynth()
 #endif
 }
 
+File InternalSynth::getSoundFontFile()
+{
+    return ProjectInfo::versionDataDir.getChildFile("Extra").getChildFile("GS").getChildFile("GeneralUser_GS.sf3");
+}
+
 void InternalSynth::extractSoundfont()
 {
 #ifdef PLUGDATA_STANDALONE
     // Unpack soundfont
+    auto soundFont = getSoundFontFile();
     if (!soundFont.existsAsFile()) {
         FileOutputStream ostream(soundFont);
         ostream.write(StandaloneBinaryData::GeneralUser_GS_sf3, StandaloneBinaryData::GeneralUser_GS_sf3Size);
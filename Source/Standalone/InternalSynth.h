@@ -22,7 +22,7 @@ public:
 
     ~InternalSynth() override;
 
-    void extractSoundfont();
+    static void extractSoundfont();
 
     // Initialise fluidsynth on another thread, because it takes a while
     void run() override;
@@ -36,7 +36,9 @@ public:
     bool isReady();
 
 private:
-    File soundFont = ProjectInfo::versionDataDir.getChildFile("Extra").getChildFile("GS").getChildFile("GeneralUser_GS.sf3");
+    static File getSoundFontFile();
+
+    File soundFont = getSoundFontFile();
 
     // Fluidsynth state
     FluidSynth* synth = nullptr;
@@ -53,21 +53,9 @@ namespace pd {
 class Patch;
 }
 
+// Incoming MIDI doesn't go through the player's MidiMessageCollector, but through a lock-free ring per device, which PluginProcessor reads from
 class PlugDataProcessorPlayer : public AudioProcessorPlayer {
 public:
-    PlugDataProcessorPlayer()
-        : midiDeviceManager(this)
-    {
-    }
-
-    void handleIncomingMidiMessage(MidiInput* input, MidiMessage const& message) override
-    {
-        auto deviceIndex = midiDeviceManager.getMidiInputDeviceIndex(input->getIdentifier());
-        if (deviceIndex >= 0) {
-            getMidiMessageCollector().addMessageToQueue(MidiDeviceManager::convertToSysExFormat(message, deviceIndex));
-        }
-    }
-
     MidiDeviceManager midiDeviceManager;
 };
 
@@ -358,7 +346,7 @@ private:
 #else
         deviceManager.addAudioCallback(this);
 #endif
-        deviceManager.addMidiInputDeviceCallback({}, &player);
+        player.midiDeviceManager.registerInputCallbacks(deviceManager);
 
         reloadAudioDeviceState(enableAudioInput, preferredDefaultDeviceName, preferredSetupOptions);
     }
@@ -367,7 +355,7 @@ private:
     {
         saveAudioDeviceState();
 
-        deviceManager.removeMidiInputDeviceCallback({}, &player);
+        player.midiDeviceManager.unregisterInputCallbacks();
 
 #if JUCE_IOS
         deviceManager.removeAudioCallback(&maxSizeEnforcer);
@@ -563,6 +563,25 @@ void TabComponent::renderArea(NVGcontext* nvg, Rectangle<int> area)
     }
 }
 
+RectangleList<int> TabComponent::getOverlayBounds()
+{
+    RectangleList<int> overlays;
+    if (!splitDropBounds.isEmpty())
+        overlays.add(splitDropBounds);
+
+    // Split divider and the outline around the active split
+    if (splits[1]) {
+        overlays.add(Rectangle<int>(splitSize - 3, 0, 6, getHeight()));
+
+        auto activeSplitBounds = activeSplitIndex ? Rectangle<int>(splitSize, 0, getWidth() - splitSize, getHeight() - 31) : Rectangle<int>(0, 0, splitSize, getHeight() - 31);
+        RectangleList<int> outline(activeSplitBounds.expanded(2));
+        outline.subtract(activeSplitBounds.reduced(2));
+        overlays.add(outline);
+    }
+
+    return overlays;
+}
+
 void TabComponent::mouseDown(MouseEvent const& e)
 {
     auto localPos = e.getEventRelativeTo(this).getPosition();
@@ -24,6 +24,7 @@ public:
     void openInPluginMode(pd::Patch::Ptr patch);
 
     void renderArea(NVGcontext* nvg, Rectangle<int> bounds);
+    RectangleList<int> getOverlayBounds();
 
     void nextTab();
     void previousTab();
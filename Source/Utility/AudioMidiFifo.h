@@ -33,6 +33,11 @@ public:
     int getNumSamplesAvailable() { return fifo.getNumReady(); }
     int getNumSamplesFree() { return fifo.getFreeSpace(); }
 
+    size_t getMemoryUsage() const
+    {
+        return static_cast<size_t>(audioBuffer.getNumChannels() * audioBuffer.getNumSamples()) * sizeof(float) + static_cast<size_t>(midiBuffer.data.capacity());
+    }
+
     void writeAudioAndMidi(dsp::AudioBlock<float> const& audioSrc, MidiBuffer const& midiSrc)
     {
         jassert(getNumSamplesFree() >= audioSrc.getNumSamples());
@@ -104,6 +104,12 @@ public:
         return peak;
     }
 
+    size_t getMemoryUsage()
+    {
+        ScopedLock lock(audioBufferMutex);
+        return static_cast<size_t>(buffer.getNumChannels() * buffer.getNumSamples() + peakBuffer.getNumChannels() * peakBuffer.getNumSamples()) * sizeof(float);
+    }
+
 private:
     int bufferSize = 0;
     int mainBufferSize = 0;
@@ -0,0 +1,164 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <array>
+#include <deque>
+
+// Keeps track of how long frames take, and lowers rendering quality step by step when we can't keep up with the frame budget
+// Each level also includes the reductions of the levels before it. Quality is raised again once there is enough headroom,
+// or when nothing was rendered for a while, since an idle canvas doesn't produce frame times to measure headroom with
+class FrameGovernor {
+public:
+    enum Quality {
+        FullQuality = 0,
+        NoShadows,
+        NoAntialiasing,
+        StraightConnections,
+        ThrottledUpdates
+    };
+
+    struct Decision {
+        Time time;
+        Quality from, to;
+        double medianFrameTime, slowFrameTime; // 50th and 95th percentile, in milliseconds
+    };
+
+    // Returns true if the quality level changed
+    bool addFrameTime(double frameTimeMs)
+    {
+        lastFrameTime = Time::getMillisecondCounterHiRes();
+
+        frameTimes[frameIndex] = frameTimeMs;
+        frameIndex = (frameIndex + 1) % windowSize;
+        numFrames = std::min(numFrames + 1, windowSize);
+
+        // Only re-evaluate once every window, so each decision is based on frames that were rendered at the current quality
+        if (++framesSinceDecision < windowSize)
+            return false;
+
+        framesSinceDecision = 0;
+
+        auto const slowFrameTime = getPercentile(0.95);
+        auto newQuality = quality;
+
+        if (slowFrameTime > frameBudget && quality < ThrottledUpdates) {
+            newQuality = static_cast<Quality>(quality + 1);
+            numWindowsWithHeadroom = 0;
+        } else if (slowFrameTime < frameBudget * 0.5 && quality > FullQuality) {
+            // Wait for two quiet windows before we restore, otherwise we'd keep switching back and forth
+            if (++numWindowsWithHeadroom >= 2) {
+                newQuality = static_cast<Quality>(quality - 1);
+                numWindowsWithHeadroom = 0;
+            }
+        } else {
+            numWindowsWithHeadroom = 0;
+        }
+
+        if (newQuality == quality)
+            return false;
+
+        setQuality(newQuality, getPercentile(0.5), slowFrameTime);
+        return true;
+    }
+
+    // Call this for frames that were skipped because there was nothing to render
+    // Raises the quality one level for every idleRecoveryTime without rendered frames, returns true if the quality level changed
+    bool addIdleFrame()
+    {
+        auto const now = Time::getMillisecondCounterHiRes();
+        if (quality == FullQuality || now - lastFrameTime < idleRecoveryTime)
+            return false;
+
+        // The frame times we have were measured under load that has passed, so start a new window
+        numFrames = 0;
+        framesSinceDecision = 0;
+        numWindowsWithHeadroom = 0;
+        lastFrameTime = now;
+
+        setQuality(static_cast<Quality>(quality - 1), 0.0, 0.0);
+        return true;
+    }
+
+    double getPercentile(double percentile) const
+    {
+        if (numFrames == 0)
+            return 0.0;
+
+        std::array<double, windowSize> sorted;
+        std::copy(frameTimes.begin(), frameTimes.begin() + numFrames, sorted.begin());
+
+        auto nth = sorted.begin() + std::min<int>(numFrames - 1, static_cast<int>(percentile * numFrames));
+        std::nth_element(sorted.begin(), nth, sorted.begin() + numFrames);
+        return *nth;
+    }
+
+    Quality getQuality() const { return quality; }
+
+    bool shouldDrawShadows() const { return quality < NoShadows; }
+    bool shouldAntialias() const { return quality < NoAntialiasing; }
+    bool shouldDrawStraightConnections() const { return quality >= StraightConnections; }
+
+    // Minimum time between GUI updates of a single object, 0 means no limit
+    double getMinimumUpdateInterval() const { return quality >= ThrottledUpdates ? 50.0 : 0.0; }
+
+    std::deque<Decision> const& getDecisions() const { return decisions; }
+
+    static String getQualityName(Quality q)
+    {
+        switch (q) {
+        case FullQuality:
+            return "full";
+        case NoShadows:
+            return "no-shadows";
+        case NoAntialiasing:
+            return "no-antialiasing";
+        case StraightConnections:
+            return "straight-connections";
+        case ThrottledUpdates:
+            return "throttled-updates";
+        }
+
+        return {};
+    }
+
+    static String toString(Decision const& decision)
+    {
+        return decision.time.toISO8601(true) + "," + getQualityName(decision.from) + "," + getQualityName(decision.to) + "," + String(decision.medianFrameTime, 2) + "," + String(decision.slowFrameTime, 2);
+    }
+
+    std::function<void(Decision const&)> onDecision;
+
+private:
+    void setQuality(Quality newQuality, double medianFrameTime, double slowFrameTime)
+    {
+        Decision decision { Time::getCurrentTime(), quality, newQuality, medianFrameTime, slowFrameTime };
+        decisions.push_back(decision);
+        if (decisions.size() > maxDecisions)
+            decisions.pop_front();
+
+        if (onDecision)
+            onDecision(decision);
+
+        quality = newQuality;
+    }
+
+    static constexpr int windowSize = 60;
+    static constexpr size_t maxDecisions = 256;
+    static constexpr double frameBudget = 14.0;
+    static constexpr double idleRecoveryTime = 1000.0;
+
+    std::array<double, windowSize> frameTimes = {};
+    int frameIndex = 0;
+    int numFrames = 0;
+    int framesSinceDecision = 0;
+    int numWindowsWithHeadroom = 0;
+    double lastFrameTime = 0.0;
+
+    Quality quality = FullQuality;
+    std::deque<Decision> decisions;
+};
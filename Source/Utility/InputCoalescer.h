@@ -0,0 +1,167 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+// Collects input that would otherwise be handled (and sent to pd) for every single mouse event, and only applies the latest state once per frame
+// Unlike RateReducer, nothing is dropped: the last drag position of a gesture is always applied, either on the next vblank or when flush() is called on mouseUp
+// Like the RateReducer it replaces, it's only enabled on Linux by default: that's where mouse events come in much faster than we can draw
+// On other platforms, they already arrive at about the display rate, so waiting for the next frame would only add latency
+class InputCoalescer {
+public:
+#if JUCE_LINUX
+    static constexpr bool enabledByDefault = true;
+#else
+    static constexpr bool enabledByDefault = false;
+#endif
+
+    explicit InputCoalescer(Component* frameSource)
+        : vBlankAttachment(frameSource, [this] { flush(); })
+    {
+    }
+
+    // Returns true if the drag was stored for the next frame, in which case the caller should ignore it for now
+    // The stored drag will be passed to target->mouseDrag() again, and then this returns false so the target can handle it
+    bool coalesceDrag(Component* target, MouseEvent const& e)
+    {
+        if (isApplying)
+            return false;
+
+        numReceived++;
+
+        if (!enabled) {
+            numApplied++;
+            return false;
+        }
+
+        for (auto& drag : pendingDrags) {
+            if (drag.target.getComponent() == target) {
+                drag.event.reset(); // MouseEvent can't be assigned
+                drag.event.emplace(e);
+                drag.eventComponent = e.eventComponent;
+                drag.originalComponent = e.originalComponent;
+                return true;
+            }
+        }
+
+        pendingDrags.push_back({ target, e, e.eventComponent, e.originalComponent });
+        return true;
+    }
+
+    // Stores an action to run on the next frame, replacing any action that is still pending for the same component
+    // Actions are dropped if their component is deleted before the next frame
+    void coalesce(Component* key, std::function<void()> action)
+    {
+        numReceived++;
+
+        if (!enabled || isApplying) {
+            numApplied++;
+            action();
+            return;
+        }
+
+        for (auto& pending : pendingActions) {
+            if (pending.key.getComponent() == key) {
+                pending.action = std::move(action);
+                return;
+            }
+        }
+
+        pendingActions.push_back({ key, std::move(action) });
+    }
+
+    // Applies everything that is pending right away, call this at the end of a gesture
+    void flush()
+    {
+        if (isApplying || (pendingDrags.empty() && pendingActions.empty()))
+            return;
+
+        ScopedValueSetter<bool> applying(isApplying, true);
+
+        // Drags go first, because they can trigger new actions
+        auto drags = std::move(pendingDrags);
+        pendingDrags.clear();
+        for (auto& drag : drags) {
+            // The event points to the components it came from, so it's dropped if any of them were deleted in the meantime
+            if (drag.target && drag.eventComponent && drag.originalComponent) {
+                numApplied++;
+                drag.target->mouseDrag(*drag.event);
+            }
+        }
+
+        auto actions = std::move(pendingActions);
+        pendingActions.clear();
+        for (auto& [key, action] : actions) {
+            if (key.getComponent()) {
+                numApplied++;
+                action();
+            }
+        }
+    }
+
+    // When disabled, all input is applied immediately
+    void setEnabled(bool shouldBeEnabled)
+    {
+        flush();
+        enabled = shouldBeEnabled;
+    }
+
+    // Number of events that came in, and the number that was actually applied
+    int getNumReceived() const { return numReceived; }
+    int getNumApplied() const { return numApplied; }
+
+    void resetCounters()
+    {
+        numReceived = 0;
+        numApplied = 0;
+    }
+
+private:
+    struct PendingDrag {
+        Component::SafePointer<Component> target;
+        std::optional<MouseEvent> event;
+        Component::SafePointer<Component> eventComponent, originalComponent;
+    };
+
+    struct PendingAction {
+        Component::SafePointer<Component> key;
+        std::function<void()> action;
+    };
+
+    std::vector<PendingDrag> pendingDrags;
+    std::vector<PendingAction> pendingActions;
+
+    bool enabled = enabledByDefault;
+    bool isApplying = false;
+
+    int numReceived = 0;
+    int numApplied = 0;
+
+    VBlankAttachment vBlankAttachment;
+};
+
+template<typename T>
+class MouseCoalescedComponent : public T {
+public:
+    using T::T;
+
+    void mouseDrag(MouseEvent const& e) override
+    {
+        if (inputCoalescer.coalesceDrag(this, e))
+            return;
+
+        T::mouseDrag(e);
+    }
+
+    void mouseUp(MouseEvent const& e) override
+    {
+        inputCoalescer.flush();
+        T::mouseUp(e);
+    }
+
+private:
+    InputCoalescer inputCoalescer { this };
+};
@@ -0,0 +1,102 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <source_location>
+#include <unordered_map>
+
+// Records how long the message thread holds pd's audio lock, and from where
+// Only the outermost lock counts when locks are nested, since that's how long the audio thread would have to wait
+class LockTelemetry {
+public:
+    struct CallSite {
+        String name;
+        int numHolds = 0;
+        double totalTime = 0.0;   // In milliseconds
+        double longestTime = 0.0; // In milliseconds
+    };
+
+    void lockAcquired(std::source_location const& location)
+    {
+        if (!MessageManager::existsAndIsCurrentThread())
+            return;
+
+        if (depth++ == 0) {
+            isRecording = enabled.load(std::memory_order_relaxed);
+            if (isRecording) {
+                heldLocation = location;
+                lockTime = Time::getMillisecondCounterHiRes();
+            }
+        }
+    }
+
+    void lockReleased()
+    {
+        if (!MessageManager::existsAndIsCurrentThread() || depth == 0)
+            return;
+
+        if (--depth > 0 || !isRecording)
+            return;
+
+        auto const holdTime = Time::getMillisecondCounterHiRes() - lockTime;
+        auto const key = std::hash<char const*>()(heldLocation.file_name()) ^ (static_cast<size_t>(heldLocation.line()) << 1);
+
+        std::lock_guard lock(callSitesMutex);
+        auto& callSite = callSites[key];
+        if (callSite.name.isEmpty())
+            callSite.name = File(heldLocation.file_name()).getFileName() + ":" + String(heldLocation.line()) + " " + heldLocation.function_name();
+
+        callSite.numHolds++;
+        callSite.totalTime += holdTime;
+        callSite.longestTime = std::max(callSite.longestTime, holdTime);
+    }
+
+    // Call sites sorted by their longest hold time, longest first
+    std::vector<CallSite> getLongestHolds(int maxNumCallSites) const
+    {
+        std::vector<CallSite> result;
+        {
+            std::lock_guard lock(callSitesMutex);
+            for (auto const& [key, callSite] : callSites) {
+                result.push_back(callSite);
+            }
+        }
+
+        std::sort(result.begin(), result.end(), [](CallSite const& a, CallSite const& b) {
+            return a.longestTime > b.longestTime;
+        });
+
+        if (result.size() > static_cast<size_t>(maxNumCallSites))
+            result.resize(maxNumCallSites);
+
+        return result;
+    }
+
+    void reset()
+    {
+        std::lock_guard lock(callSitesMutex);
+        callSites.clear();
+    }
+
+    static String toString(CallSite const& callSite)
+    {
+        return callSite.name + ": " + String(callSite.numHolds) + " holds, " + String(callSite.longestTime, 2) + " ms longest, " + String(callSite.totalTime / std::max(1, callSite.numHolds), 3) + " ms average";
+    }
+
+    std::atomic<bool> enabled = false;
+
+private:
+    // Only used from the message thread
+    int depth = 0;
+    bool isRecording = false;
+    double lockTime = 0.0;
+    std::source_location heldLocation;
+
+    mutable std::mutex callSitesMutex;
+    std::unordered_map<size_t, CallSite> callSites;
+};
@@ -7,6 +7,7 @@
 #pragma once
 #include <juce_audio_utils/juce_audio_utils.h>
 #include "Standalone/InternalSynth.h"
+#include "Utility/MidiInputRing.h"
 
 class MidiDeviceManager : public ChangeListener
     , public AsyncUpdater {
@@ -80,18 +81,70 @@ public:
         return m;
     }
 
-    MidiDeviceManager(MidiInputCallback* inputCallback)
+    // Same as convertToSysExFormat, but works on the raw event and encodes into a buffer that can be reused
+    static void convertToSysExFormat(uint8 const* data, int size, int device, std::vector<uint8>& result)
     {
+        auto const append = [&result](uint8 byte) {
+            auto const value = byte == 0xF0 || byte == 0xF7 ? static_cast<uint16_t>(byte << 1) : static_cast<uint16_t>(byte);
+            uint8 bytes[sizeof(uint16_t)];
+            std::memcpy(bytes, &value, sizeof(uint16_t));
+            result.insert(result.end(), bytes, bytes + sizeof(uint16_t));
+        };
+
+        result.clear();
+        result.push_back(0xf0);
+        for (int i = 0; i < size; i++) {
+            append(data[i]);
+        }
+        append(static_cast<uint8>(device));
+        result.push_back(0xf7);
+    }
+
+    // Same as convertFromSysExFormat, but works on the raw event and decodes into a buffer that can be reused, so the audio thread doesn't allocate
+    static void convertFromSysExFormat(uint8 const* data, int size, std::vector<uint8>& result, int& device)
+    {
+        result.clear();
+        device = 0;
+
+        if (!ProjectInfo::isStandalone || size < 2 || data[0] != 0xf0) {
+            result.insert(result.end(), data, data + size);
+            return;
+        }
+
+        auto const numValues = (size - 2) / static_cast<int>(sizeof(uint16_t));
+        for (int i = 0; i < numValues; i++) {
+            uint16_t value;
+            std::memcpy(&value, data + 1 + i * sizeof(uint16_t), sizeof(uint16_t));
+
+            auto upperByte = value >> 1;
+            result.push_back(upperByte == 0xF0 || upperByte == 0xF7 ? upperByte : static_cast<uint8_t>(value));
+        }
+
+        if (!result.empty()) {
+            device = result.back();
+            result.pop_back();
+        }
+    }
+
+    MidiDeviceManager()
+    {
+        sysExEncodeBuffer.reserve(inputRingSize * sizeof(uint16_t) + 4);
+
 #if !JUCE_WINDOWS && !JUCE_IOS
         if (auto* newOut = MidiOutput::createNewDevice("from plugdata").release()) {
             fromPlugdata.reset(newOut);
         }
-        if (auto* newIn = MidiInput::createNewDevice("to plugdata", inputCallback).release()) {
+
+        // The virtual input feeds its own port, its identifier is only known once it's created
+        auto* internalPort = addInputPort({});
+        if (auto* newIn = MidiInput::createNewDevice("to plugdata", internalPort).release()) {
             toPlugdata.reset(newIn);
+            internalPort->identifier = toPlugdata->getIdentifier();
         }
 #endif
         if (auto* deviceManager = ProjectInfo::getDeviceManager()) {
             deviceManager->addChangeListener(this);
+            listenedDeviceManager = deviceManager;
         }
 
         filteredMidiInputs = filteredMidiOutputs = 0;
@@ -100,6 +153,10 @@ public:
 
     ~MidiDeviceManager()
     {
+        // The virtual input calls into one of our ports, so it has to go first
+        unregisterInputCallbacks();
+        toPlugdata.reset();
+
         saveMidiOutputSettings();
         clearInputFilter();
         clearOutputFilter();
@@ -188,6 +245,7 @@ public:
         midiDeviceMutex.unlock();
         clearInputFilter();
         clearOutputFilter();
+        updateInputPorts();
     }
 
     Array<MidiDeviceInfo> getInputDevicesUnfiltered()
@@ -316,6 +374,7 @@ public:
             if (shouldBeEnabled != internalInputEnabled) {
                 clearInputFilter();
                 internalInputEnabled = shouldBeEnabled;
+                updateInputPorts();
                 if (internalInputEnabled) {
                     toPlugdata->start();
                 } else {
@@ -326,6 +385,7 @@ public:
             if (shouldBeEnabled != isMidiDeviceEnabled(true, identifier)) {
                 ProjectInfo::getDeviceManager()->setMidiInputDeviceEnabled(identifier, shouldBeEnabled);
                 clearInputFilter();
+                updateInputPorts();
             }
         } else if (shouldBeEnabled != isMidiDeviceEnabled(false, identifier)) {
             clearOutputFilter();
@@ -374,20 +434,168 @@ public:
         }
     }
 
-    int getMidiInputDeviceIndex(String const& identifier)
+    // Starts receiving MIDI from every input device, each through its own handler
+    void registerInputCallbacks(AudioDeviceManager& deviceManager)
     {
-        auto devices = getInputDevices();
+        inputDeviceManager = &deviceManager;
 
-        for (int i = 0; i < devices.size(); i++) {
-            if (devices[i].identifier == identifier) {
-                return i;
-            }
+        // So devices that are plugged in later also get a handler
+        // If we already listen to this device manager, unregistering must leave that listener in place
+        addedInputListener = inputDeviceManager != listenedDeviceManager;
+        if (addedInputListener)
+            inputDeviceManager->addChangeListener(this);
+
+        updateInputPorts();
+    }
+
+    void unregisterInputCallbacks()
+    {
+        if (!inputDeviceManager)
+            return;
+
+        for (auto* port : ownedInputPorts) {
+            if (port->isRegistered)
+                inputDeviceManager->removeMidiInputDeviceCallback(port->identifier, port);
+            port->isRegistered = false;
         }
 
-        return -1;
+        if (addedInputListener)
+            inputDeviceManager->removeChangeListener(this);
+
+        addedInputListener = false;
+        inputDeviceManager = nullptr;
+    }
+
+    // Called on the audio thread: moves the MIDI that came in since the last block into the buffer, in the sysex format that carries the device index
+    // Events are placed according to their driver timestamps, so they keep their spacing within the block
+    void dequeueMidiInput(MidiBuffer& buffer, int numSamples, double sampleRate)
+    {
+        auto const blockStart = Time::getMillisecondCounterHiRes() * 0.001 - numSamples / sampleRate;
+        auto const numPorts = numInputPorts.load(std::memory_order_acquire);
+
+        for (int i = 0; i < numPorts; i++) {
+            auto* port = inputPorts[i];
+            auto const device = port->deviceIndex.load(std::memory_order_relaxed);
+            port->ring.popAll([this, &buffer, device, blockStart, numSamples, sampleRate](uint8 const* data, int size, double timestamp) {
+                if (device < 0)
+                    return;
+
+                auto const position = jlimit(0, numSamples - 1, roundToInt((timestamp - blockStart) * sampleRate));
+                convertToSysExFormat(data, size, device, sysExEncodeBuffer);
+                buffer.addEvent(sysExEncodeBuffer.data(), static_cast<int>(sysExEncodeBuffer.size()), position);
+            });
+        }
     }
 
 private:
+    static constexpr int maxInputPorts = 64;
+    static constexpr int inputRingSize = 1 << 16;
+
+    // Receives the MIDI of a single input device on the driver thread, and passes it to the audio thread through a lock-free ring
+    // The device index is resolved on the message thread whenever the device list changes, so incoming events don't need to look anything up
+    struct MidiInputPort : public MidiInputCallback {
+        void handleIncomingMidiMessage(MidiInput* source, MidiMessage const& message) override
+        {
+            if (deviceIndex.load(std::memory_order_relaxed) >= 0)
+                ring.push(message.getRawData(), message.getRawDataSize(), message.getTimeStamp());
+        }
+
+        String identifier;
+        std::atomic<int> deviceIndex = -1;
+        bool isRegistered = false;
+        bool isFree = false;
+        MidiInputRing ring { inputRingSize };
+    };
+
+    MidiInputPort* addInputPort(String const& identifier)
+    {
+        // A port is only reused once the audio thread has read everything its last device sent, so those events can't end up tagged with the new device
+        for (auto* port : ownedInputPorts) {
+            if (port->isFree && port->ring.isEmpty()) {
+                port->isFree = false;
+                port->identifier = identifier;
+                return port;
+            }
+        }
+
+        if (ownedInputPorts.size() >= maxInputPorts) {
+            if (!reachedMaxInputPorts)
+                std::cerr << "Too many MIDI input devices, only the first " << maxInputPorts << " will be received" << std::endl;
+
+            reachedMaxInputPorts = true;
+            return nullptr;
+        }
+
+        auto* port = ownedInputPorts.add(new MidiInputPort());
+        port->identifier = identifier;
+
+        inputPorts[numInputPorts.load(std::memory_order_relaxed)] = port;
+        numInputPorts.fetch_add(1, std::memory_order_release);
+        return port;
+    }
+
+    // Stops the handler of a device that was unplugged, and lets the next new device use it
+    void releaseInputPort(MidiInputPort* port)
+    {
+        if (port->isRegistered && inputDeviceManager)
+            inputDeviceManager->removeMidiInputDeviceCallback(port->identifier, port);
+
+        port->isRegistered = false;
+        port->isFree = true;
+        port->identifier = {};
+        port->deviceIndex.store(-1, std::memory_order_relaxed);
+        reachedMaxInputPorts = false;
+    }
+
+    // Creates a handler for every input device we haven't seen before, and updates the device index that each handler tags its events with
+    // Handlers are never deleted while the app runs, so the audio thread can always safely read from them. Handlers of unplugged devices get recycled instead
+    void updateInputPorts()
+    {
+        for (auto* port : ownedInputPorts) {
+            if (port->isFree || (toPlugdata && port->identifier == toPlugdata->getIdentifier()))
+                continue;
+
+            auto const isAvailable = std::any_of(lastMidiInputs.begin(), lastMidiInputs.end(), [port](auto const& device) { return device.identifier == port->identifier; });
+            if (!isAvailable)
+                releaseInputPort(port);
+        }
+
+        for (auto const& device : lastMidiInputs) {
+            if (toPlugdata && device.identifier == toPlugdata->getIdentifier())
+                continue;
+
+            auto* port = getInputPort(device.identifier);
+            if (!port)
+                port = addInputPort(device.identifier);
+
+            if (port && inputDeviceManager && !port->isRegistered) {
+                inputDeviceManager->addMidiInputDeviceCallback(device.identifier, port);
+                port->isRegistered = true;
+            }
+        }
+
+        auto const devices = getInputDevices();
+        for (auto* port : ownedInputPorts) {
+            auto index = -1;
+            for (int i = 0; i < devices.size(); i++) {
+                if (devices[i].identifier == port->identifier) {
+                    index = i;
+                    break;
+                }
+            }
+            port->deviceIndex.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    MidiInputPort* getInputPort(String const& identifier)
+    {
+        for (auto* port : ownedInputPorts) {
+            if (port->identifier == identifier)
+                return port;
+        }
+        return nullptr;
+    }
+
     bool internalOutputEnabled = false;
     bool internalInputEnabled = false;
 
@@ -406,4 +614,17 @@ private:
 
     Array<MidiDeviceInfo>* filteredMidiInputs;
     Array<MidiDeviceInfo>* filteredMidiOutputs;
+
+    // Input handlers, only added to on the message thread
+    OwnedArray<MidiInputPort> ownedInputPorts;
+    std::array<MidiInputPort*, maxInputPorts> inputPorts = {};
+    std::atomic<int> numInputPorts = 0;
+    bool reachedMaxInputPorts = false;
+
+    AudioDeviceManager* inputDeviceManager = nullptr;
+    AudioDeviceManager* listenedDeviceManager = nullptr; // The device manager we listen to since construction
+    bool addedInputListener = false;
+
+    // Only used on the audio thread
+    std::vector<uint8> sysExEncodeBuffer;
 };
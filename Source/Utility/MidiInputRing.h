@@ -0,0 +1,97 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+// Single producer, single consumer queue for the MIDI of one input device, that never locks or allocates
+// The driver thread pushes raw events with their timestamp, and the audio thread pops them
+// Each event is stored as a small header followed by its bytes, so long sysex messages fit as well
+class MidiInputRing {
+public:
+    explicit MidiInputRing(int capacityInBytes = 1 << 16)
+        : capacity(static_cast<uint64>(nextPowerOfTwo(capacityInBytes)))
+        , buffer(capacity)
+        , readBuffer(capacity)
+    {
+    }
+
+    // Producer side, returns false if the event doesn't fit, in which case it's dropped
+    bool push(uint8 const* data, int size, double timestamp)
+    {
+        auto const recordSize = sizeof(Header) + static_cast<uint64>(size);
+        auto const write = writePosition.load(std::memory_order_relaxed);
+        auto const read = readPosition.load(std::memory_order_acquire);
+
+        if (size <= 0 || recordSize > capacity - (write - read)) {
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Header const header { timestamp, size };
+        copyIn(write, &header, sizeof(Header));
+        copyIn(write + sizeof(Header), data, size);
+
+        writePosition.store(write + recordSize, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, calls callback(data, size, timestamp) for every event in the order they were pushed
+    template<typename Callback>
+    void popAll(Callback&& callback)
+    {
+        auto read = readPosition.load(std::memory_order_relaxed);
+        auto const write = writePosition.load(std::memory_order_acquire);
+
+        while (read != write) {
+            Header header;
+            copyOut(read, &header, sizeof(Header));
+            copyOut(read + sizeof(Header), readBuffer.data(), header.size);
+
+            read += sizeof(Header) + static_cast<uint64>(header.size);
+            readPosition.store(read, std::memory_order_release);
+
+            callback(static_cast<uint8 const*>(readBuffer.data()), header.size, header.timestamp);
+        }
+    }
+
+    bool isEmpty() const
+    {
+        return readPosition.load(std::memory_order_acquire) == writePosition.load(std::memory_order_acquire);
+    }
+
+    int getNumDropped() const { return numDropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Header {
+        double timestamp;
+        int size;
+    };
+
+    void copyIn(uint64 position, void const* source, size_t numBytes)
+    {
+        auto const index = position & (capacity - 1);
+        auto const firstPart = std::min<size_t>(numBytes, capacity - index);
+        std::memcpy(buffer.data() + index, source, firstPart);
+        std::memcpy(buffer.data(), static_cast<uint8 const*>(source) + firstPart, numBytes - firstPart);
+    }
+
+    void copyOut(uint64 position, void* destination, size_t numBytes) const
+    {
+        auto const index = position & (capacity - 1);
+        auto const firstPart = std::min<size_t>(numBytes, capacity - index);
+        std::memcpy(destination, buffer.data() + index, firstPart);
+        std::memcpy(static_cast<uint8*>(destination) + firstPart, buffer.data(), numBytes - firstPart);
+    }
+
+    uint64 const capacity;
+    std::vector<uint8> buffer;
+    std::vector<uint8> readBuffer;
+
+    // Positions only ever increase, and are wrapped when indexing into the buffer
+    alignas(64) std::atomic<uint64> writePosition = 0;
+    alignas(64) std::atomic<uint64> readPosition = 0;
+    std::atomic<int> numDropped = 0;
+};
@@ -4,12 +4,16 @@
  // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
  */
 
-#define JUCE_GUI_BASICS_INCLUDE_XHEADERS 1
-#include <juce_gui_basics/juce_gui_basics.h>
+#if PLUGDATA_HEADLESS
+#    include <juce_core/juce_core.h>
+#else
+#    define JUCE_GUI_BASICS_INCLUDE_XHEADERS 1
+#    include <juce_gui_basics/juce_gui_basics.h>
 
-#if !defined(__APPLE__)
-#    undef JUCE_GUI_BASICS_INCLUDE_XHEADERS
-#    include <raw_keyboard_input/raw_keyboard_input.cpp>
+#    if !defined(__APPLE__)
+#        undef JUCE_GUI_BASICS_INCLUDE_XHEADERS
+#        include <raw_keyboard_input/raw_keyboard_input.cpp>
+#    endif
 #endif
 
 #include "OSUtils.h"
@@ -193,7 +197,7 @@ OSUtils::KeyboardLayout OSUtils::getKeyboardLayout()
 #endif // Windows
 
 // Selects Linux and BSD
-#if defined(__unix__) && !defined(__APPLE__)
+#if defined(__unix__) && !defined(__APPLE__) && !PLUGDATA_HEADLESS
 
 void OSUtils::updateX11Constraints(void* handle)
 {
@@ -66,6 +66,16 @@ void OSUtils::HideTitlebarButtons(void* view, bool hideMinimiseButton, bool hide
         [closeButton setEnabled: hideCloseButton ? NO : YES];
 }
 
+// True if no part of the window can be seen, because it's covered by other windows, or on another space
+bool OSUtils::isWindowOccluded(void* view)
+{
+    NSWindow* window = [static_cast<NSView*>(view) window];
+    if (!window)
+        return false;
+
+    return ([window occlusionState] & NSWindowOcclusionStateVisible) == 0;
+}
+
 OSUtils::KeyboardLayout OSUtils::getKeyboardLayout()
 {
     TISInputSourceRef source = TISCopyCurrentKeyboardInputSource();
@@ -6,7 +6,11 @@
 
 #pragma once
 
-#include <juce_gui_basics/juce_gui_basics.h>
+#if !PLUGDATA_HEADLESS
+#    include <juce_gui_basics/juce_gui_basics.h>
+#endif
+
+#include "Constants.h"
 
 /*
  * This is a static class that handles all theming & formatting for UI objects placed onto the canvas
@@ -25,6 +29,7 @@ public:
         return instance;
     }
 
+#if !PLUGDATA_HEADLESS
     void updateTheme()
     {
         auto& lnf = LookAndFeel::getDefaultLookAndFeel();
@@ -33,6 +38,7 @@ public:
         lbl = lnf.findColour(PlugDataColour::toolbarTextColourId);
         ln = lnf.findColour(PlugDataColour::guiObjectInternalOutlineColour);
     }
+#endif
 
     String getCompleteFormat(String& name)
     {
@@ -193,6 +193,96 @@ public:
         return &value;
     }
 
+    // Parameter state is stored as a binary chunk: a header, a table of names, and one fixed-size record per parameter
+    // Records are stored in parameter order, so loading doesn't need to look anything up
+    // Parameters that still have their default name ("param" + index) don't get an entry in the name table
+    static void saveStateInformation(OutputStream& output, Array<AudioProcessorParameter*> const& parameters)
+    {
+        auto const numParameters = parameters.size() - 1;
+
+        StringArray names;
+        std::vector<int> nameIndices(numParameters, -1);
+        for (int i = 0; i < numParameters; i++) {
+            auto const name = dynamic_cast<PlugDataParameter*>(parameters[i + 1])->getTitle();
+            if (name != getDefaultName(i + 1)) {
+                nameIndices[i] = names.size();
+                names.add(name);
+            }
+        }
+
+        output.writeInt(static_cast<int>(stateMagic));
+        output.writeInt(stateVersion);
+        output.writeFloat(parameters[0]->getValue());
+
+        output.writeInt(names.size());
+        for (auto const& name : names) {
+            output.writeString(name);
+        }
+
+        output.writeInt(numParameters);
+        for (int i = 0; i < numParameters; i++) {
+            auto* param = dynamic_cast<PlugDataParameter*>(parameters[i + 1]);
+            auto const range = param->getNormalisableRange();
+
+            output.writeFloat(param->getValue());
+            output.writeFloat(range.start);
+            output.writeFloat(range.end);
+            output.writeInt(param->index);
+            output.writeInt(nameIndices[i]);
+            output.writeByte(static_cast<char>(param->mode));
+            output.writeByte(static_cast<char>(param->enabled.load()));
+        }
+    }
+
+    // Returns false if the data isn't a valid parameter chunk, without changing any parameters
+    static bool loadStateInformation(InputStream& input, Array<AudioProcessorParameter*> const& parameters)
+    {
+        if (static_cast<uint32>(input.readInt()) != stateMagic || input.readInt() != stateVersion)
+            return false;
+
+        auto const volume = input.readFloat();
+
+        auto const numNames = input.readInt();
+        if (numNames < 0 || numNames > parameters.size())
+            return false;
+
+        StringArray names;
+        names.ensureStorageAllocated(numNames);
+        for (int i = 0; i < numNames; i++) {
+            names.add(input.readString());
+        }
+
+        auto const numRecords = input.readInt();
+        if (numRecords < 0 || input.getNumBytesRemaining() < static_cast<int64>(numRecords) * recordSize)
+            return false;
+
+        parameters[0]->setValueNotifyingHost(volume);
+
+        // Sessions from a build with more parameters than this one lose the extra ones
+        auto const numParameters = std::min(numRecords, parameters.size() - 1);
+        for (int i = 0; i < numParameters; i++) {
+            auto* param = dynamic_cast<PlugDataParameter*>(parameters[i + 1]);
+
+            auto const value = input.readFloat();
+            auto const min = input.readFloat();
+            auto const max = input.readFloat();
+            auto const index = input.readInt();
+            auto const nameIndex = input.readInt();
+            auto const mode = static_cast<Mode>(std::clamp<int>(input.readByte(), Float, Exponential));
+            auto const enabled = input.readByte() != 0;
+
+            param->setRange(min, max);
+            param->setName(isPositiveAndBelow(nameIndex, numNames) ? names[nameIndex] : getDefaultName(i + 1));
+            param->setIndex(index);
+            param->setMode(mode, false);
+            param->setValue(value);
+            param->setEnabled(enabled);
+        }
+
+        return true;
+    }
+
+    // Legacy format, still written next to the binary chunk so older versions of plugdata can load the parameters
     static void saveStateInformation(XmlElement& xml, Array<AudioProcessorParameter*> const& parameters)
     {
         auto* volumeXml = new XmlElement("PARAM");
@@ -204,9 +294,14 @@ public:
 
             auto* param = dynamic_cast<PlugDataParameter*>(parameters[i]);
 
+            // Most parameters are never used, leaving them out keeps the xml small
+            // Loading resets parameters without a PARAM element to their defaults
+            if (param->hasDefaultState(i))
+                continue;
+
             auto* paramXml = new XmlElement("PARAM");
 
-            paramXml->setAttribute("id", String("param") + String(i));
+            paramXml->setAttribute("id", getDefaultName(i));
 
             paramXml->setAttribute(String("name"), param->getTitle());
             paramXml->setAttribute(String("min"), param->getNormalisableRange().start);
@@ -221,9 +316,21 @@ public:
         }
     }
 
+    // Import for sessions saved before the binary parameter chunk
     static void loadStateInformation(XmlElement const& xml, Array<AudioProcessorParameter*> const& parameters)
     {
-        auto* volumeParam = xml.getChildByAttribute("id", "volume");
+        // Index the PARAM elements once, instead of searching the children for every parameter
+        std::unordered_map<String, XmlElement const*> paramElements;
+        for (auto* child : xml.getChildWithTagNameIterator("PARAM")) {
+            paramElements.try_emplace(child->getStringAttribute("id"), child);
+        }
+
+        auto getParamElement = [&paramElements](String const& id) -> XmlElement const* {
+            auto it = paramElements.find(id);
+            return it != paramElements.end() ? it->second : nullptr;
+        };
+
+        auto* volumeParam = getParamElement("volume");
         if (volumeParam) {
             auto const navalue = static_cast<float>(volumeParam->getDoubleAttribute(String("value"),
                 static_cast<double>(parameters[0]->getValue())));
@@ -234,15 +341,18 @@ public:
         for (int i = 1; i < parameters.size(); i++) {
             auto* param = dynamic_cast<PlugDataParameter*>(parameters[i]);
 
-            auto xmlParam = xml.getChildByAttribute("id", "param" + String(i));
+            auto const defaultName = getDefaultName(i);
+            auto* xmlParam = getParamElement(defaultName);
 
-            if (!xmlParam)
+            if (!xmlParam) {
+                param->resetToDefaultState(i);
                 continue;
+            }
 
             auto const navalue = static_cast<float>(xmlParam->getDoubleAttribute(String("value"),
                 static_cast<double>(param->getValue())));
 
-            String name = "param" + String(i);
+            String name = defaultName;
             float min = 0.0f, max = 1.0f;
             bool enabled = true;
             int index = i;
@@ -317,6 +427,33 @@ public:
     }
 
 private:
+    static String getDefaultName(int parameterNumber)
+    {
+        return "param" + String(parameterNumber);
+    }
+
+    // True for a parameter that is still in the state the processor created it in
+    bool hasDefaultState(int parameterNumber) const
+    {
+        auto const range = getNormalisableRange();
+        return !isEnabled() && mode == Float && index == parameterNumber && range.start == 0.0f && range.end == 1.0f
+            && getValue() == getDefaultValue() && getTitle() == getDefaultName(parameterNumber);
+    }
+
+    void resetToDefaultState(int parameterNumber)
+    {
+        setRange(0.0f, 1.0f);
+        setName(getDefaultName(parameterNumber));
+        setIndex(parameterNumber);
+        setMode(Float, false);
+        setValue(getDefaultValue());
+        setEnabled(false);
+    }
+
+    static constexpr uint32 stateMagic = 0x52504450; // "PDPR"
+    static constexpr int stateVersion = 1;
+    static constexpr int recordSize = 3 * sizeof(float) + 2 * sizeof(int) + 2; // value, min, max, index, name index, mode, enabled
+
     float lastValue = 0.0f;
     float const defaultValue;
 
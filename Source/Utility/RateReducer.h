@@ -40,20 +40,3 @@ private:
     int timerHz;
     bool allowEvent = true;
 };
-
-template<typename T, int hz = 90>
-class MouseRateReducedComponent : public T {
-public:
-    using T::T;
-
-    void mouseDrag(MouseEvent const& e) override
-    {
-        if (rateReducer.tooFast())
-            return;
-
-        T::mouseDrag(e);
-    }
-
-private:
-    RateReducer rateReducer = RateReducer(hz);
-};
@@ -27,8 +27,9 @@ JUCE_IMPLEMENT_SINGLETON(SettingsFile)
 
 SettingsFile::~SettingsFile()
 {
-    // Save current settings before quitting
-    saveSettings();
+    // Save current settings before quitting, after any background save that is still in progress
+    saveThread.removeAllJobs(false, 10000);
+    writeSettings(settingsTree.toXmlString());
 
     clearSingletonInstance();
 }
@@ -335,22 +336,31 @@ void SettingsFile::initialiseOverlayTree()
 
 void SettingsFile::reloadSettings()
 {
-    if (settingsChangedInternally) {
-        settingsChangedInternally = false;
-        return;
-    }
+    jassert(isInitialised);
 
-    settingsChangedExternally = true;
+    auto content = settingsFile.loadFileAsString();
 
-    jassert(isInitialised);
+    // The file watcher also sees our own writes, those are already in the tree
+    auto const hash = content.hashCode64();
+    if (hash == lastWrittenHash || hash == pendingWriteHash)
+        return;
 
-    auto newTree = ValueTree::fromXml(settingsFile.loadFileAsString());
+    auto newTree = ValueTree::fromXml(content);
+    if (!newTree.isValid() || newTree.isEquivalentTo(settingsTree))
+        return;
+
+    settingsChangedExternally = true;
 
     // Children shouldn't be overwritten as that would break some valueTree links
+    // Only replace the ones that changed, so listeners to the other children don't get notified
     for (auto child : settingsTree) {
-        child.copyPropertiesAndChildrenFrom(newTree.getChildWithName(child.getType()), nullptr);
+        auto newChild = newTree.getChildWithName(child.getType());
+        if (!child.isEquivalentTo(newChild)) {
+            child.copyPropertiesAndChildrenFrom(newChild, nullptr);
+        }
     }
 
+    // This only sends change messages for properties that have a different value
     settingsTree.copyPropertiesFrom(newTree, nullptr);
 
     for (auto* listener : listeners) {
@@ -371,22 +381,16 @@ void SettingsFile::valueTreePropertyChanged(ValueTree& treeWhosePropertyHasChang
         listener->propertyChanged(property.toString(), treeWhosePropertyHasChanged.getProperty(property));
     }
 
-    if (!settingsChangedExternally)
-        settingsChangedInternally = true;
     startTimer(700);
 }
 
 void SettingsFile::valueTreeChildAdded(ValueTree& parentTree, ValueTree& childWhichHasBeenAdded)
 {
-    if (!settingsChangedExternally)
-        settingsChangedInternally = true;
     startTimer(700);
 }
 
 void SettingsFile::valueTreeChildRemoved(ValueTree& parentTree, ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
 {
-    if (!settingsChangedExternally)
-        settingsChangedInternally = true;
     startTimer(700);
 }
 
@@ -416,9 +420,43 @@ void SettingsFile::setGlobalScale(float newScale)
 void SettingsFile::saveSettings()
 {
     jassert(isInitialised);
-    // Save settings to file
-    auto xml = settingsTree.toXmlString();
-    settingsFile.replaceWithText(xml);
+
+    // Copying the tree is cheap compared to serialising and writing it, so only the copy happens on the message thread
+    // If a save is already queued, it will pick up the newer copy
+    {
+        ScopedLock lock(saveLock);
+        auto const saveIsQueued = pendingSnapshot.isValid();
+        pendingSnapshot = settingsTree.createCopy();
+        if (saveIsQueued)
+            return;
+    }
+
+    saveThread.addJob([this]() {
+        ValueTree snapshot;
+        {
+            ScopedLock lock(saveLock);
+            std::swap(snapshot, pendingSnapshot);
+        }
+
+        writeSettings(snapshot.toXmlString());
+    });
+}
+
+void SettingsFile::writeSettings(String const& xml)
+{
+    auto const hash = xml.hashCode64();
+    if (hash == lastWrittenHash)
+        return;
+
+    // Write to a temporary file and move it over the settings file, so other instances never read a half-written file
+    // lastWrittenHash is only updated once the file was actually replaced, so a failed write is retried on the next save
+    // The file watcher can see the new file before that, so it also ignores the write that's in progress
+    pendingWriteHash = hash;
+    TemporaryFile tempFile(settingsFile);
+    if (tempFile.getFile().replaceWithText(xml) && tempFile.overwriteTargetFileWithTemporary()) {
+        lastWrittenHash = hash;
+    }
+    pendingWriteHash = 0;
 }
 
 void SettingsFile::setProperty(String const& name, var const& value)
@@ -58,6 +58,7 @@ public:
 
     void timerCallback() override;
 
+    // Writes the settings on a background thread
     void saveSettings();
 
     void setProperty(String const& name, var const& value);
@@ -87,6 +88,8 @@ public:
     void setGlobalScale(float newScale);
 
 private:
+    void writeSettings(String const& xml);
+
     bool isInitialised = false;
 
     FileSystemWatcher settingsFileWatcher;
@@ -95,9 +98,17 @@ private:
 
     File settingsFile = ProjectInfo::appDataDir.getChildFile(".settings");
     ValueTree settingsTree = ValueTree("SettingsTree");
-    bool settingsChangedInternally = false;
     bool settingsChangedExternally = false;
 
+    // Copy of the tree that is waiting to be written by the save thread
+    CriticalSection saveLock;
+    ValueTree pendingSnapshot;
+    ThreadPool saveThread { 1 };
+
+    // Hash of the last file contents we wrote, so the file watcher can ignore our own writes
+    std::atomic<int64> lastWrittenHash = 0;
+    std::atomic<int64> pendingWriteHash = 0;
+
     std::vector<std::pair<String, var>> defaultSettings {
         { "browser_path", var(ProjectInfo::appDataDir.getFullPathName()) },
         { "theme", var("light") },
@@ -131,6 +142,9 @@ private:
         { "autosave_interautosave_interval", var(120) },
         { "autosave_enabled", var(1) },
         { "patch_downwards_only", var(false) }, // Option to replicate PD-Vanilla patching downwards only
+        { "patch_cache", var(false) },          // Store parsed patches in .pdc files next to the patch, to speed up opening
+        { "audio_lock_guard", var(false) },     // Don't let the audio thread wait for the GUI, drop the block instead
+        { "frame_governor_log", var(false) },   // Write render quality changes to frame-governor.csv in the plugdata folder
         { "macos_buttons",
 #if JUCE_MAC
             var(true)
@@ -4,6 +4,7 @@
 
 // Lock-free multithread (single consumer/single producer) stack implementation
 // Before you start popping values, you need to call swapBuffers(). Other than that, push/pop like a regular stack implementation
+// The producer never allocates: push() fails when the back buffer is full. The consumer grows the buffers in swapBuffers() once they start filling up
 
 #pragma once
 #include <atomic>
@@ -12,7 +13,7 @@
 #include <mutex>
 #include <plf_stack/plf_stack.h>
 
-template<typename T, int stackSize>
+template<typename T, int initialCapacity>
 class ThreadSafeStack {
 
     using StackBuffer = plf::stack<T>;
@@ -20,14 +21,15 @@ class ThreadSafeStack {
     StackBuffer* frontBuffer;
     StackBuffer* backBuffer;
     std::mutex swapLock;
+    size_t capacity = initialCapacity; // Only used by the consumer
 
 public:
     ThreadSafeStack()
     {
         frontBuffer = &buffers[0];
         backBuffer = &buffers[1];
-        frontBuffer->reserve(stackSize);
-        backBuffer->reserve(stackSize);
+        frontBuffer->reserve(initialCapacity);
+        backBuffer->reserve(initialCapacity);
     }
 
     bool isEmpty()
@@ -39,17 +41,40 @@ public:
     // Swap front and back buffers
     void swapBuffers()
     {
-        std::lock_guard<std::mutex> lock(swapLock);
-        backBuffer = std::exchange(frontBuffer, backBuffer);
+        // The front buffer has been drained, and the producer doesn't use it, so it can grow here without holding up the producer
+        if (frontBuffer->capacity() < capacity)
+            frontBuffer->reserve(capacity);
+
+        {
+            std::lock_guard<std::mutex> lock(swapLock);
+            backBuffer = std::exchange(frontBuffer, backBuffer);
 #if JUCE_DEBUG
-        jassert(backBuffer->empty());
+            jassert(backBuffer->empty());
 #endif
+        }
+
+        // The front buffer now holds everything pushed since the last swap
+        // If that got past half the capacity, the next buffers get twice the room, so a slowly growing load never reaches the limit
+        if (frontBuffer->size() > capacity / 2)
+            capacity = std::max(capacity, frontBuffer->size()) * 2;
     }
 
-    void push(T const& value)
+    // Returns false if the back buffer is full
+    bool push(T const& value)
     {
         std::lock_guard<std::mutex> lock(swapLock);
+        if (backBuffer->size() >= backBuffer->capacity())
+            return false;
+
         backBuffer->push(value);
+        return true;
+    }
+
+    // Number of bytes currently allocated by both buffers
+    size_t getMemoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(swapLock);
+        return buffers[0].memory() + buffers[1].memory();
     }
 
     bool pop(T& result)
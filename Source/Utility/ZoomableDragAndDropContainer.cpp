@@ -23,7 +23,7 @@
   ==============================================================================
 */
 #include "ZoomableDragAndDropContainer.h"
-#include "RateReducer.h"
+#include "InputCoalescer.h"
 
 #include "Constants.h"
 #include "LookAndFeel.h"
@@ -91,6 +91,9 @@ public:
 
     void mouseUp(MouseEvent const& e) override
     {
+        // Make sure the drop target is found from the last drag position
+        inputCoalescer.flush();
+
         if (e.originalComponent != this && isOriginalInputSource(e.source)) {
             if (mouseDragSource != nullptr)
                 mouseDragSource->removeMouseListener(this);
@@ -122,7 +125,7 @@ public:
     void mouseDrag(MouseEvent const& e) override
     {
         if (e.originalComponent != this && isOriginalInputSource(e.source)) {
-            if (rateReducer.tooFast())
+            if (inputCoalescer.coalesceDrag(this, e))
                 return;
 
             beginDragAutoRepeat(16);
@@ -291,7 +294,7 @@ private:
     WeakReference<Component> mouseDragSource, currentlyOverComp;
     Point<int> const imageOffset;
     Point<int> currentScreenPos;
-    RateReducer rateReducer = RateReducer(60);
+    InputCoalescer inputCoalescer { this };
     bool hasCheckedForExternalDrag = false;
     Time lastTimeOverTarget;
     int originalInputSourceIndex;
@@ -0,0 +1,96 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+// Generated patches and measurements shared by the tests and the benchmark executables
+// The patches are generated, so results are comparable between machines and releases without shipping patch files
+
+#if JUCE_LINUX || JUCE_BSD
+#    include <unistd.h>
+#elif JUCE_MAC
+#    include <mach/mach.h>
+#endif
+
+// Resident memory of this process in bytes, or 0 where we can't measure it
+inline int64 getResidentMemory()
+{
+#if JUCE_LINUX || JUCE_BSD
+    auto statm = File("/proc/self/statm").loadFileAsString();
+    auto pages = StringArray::fromTokens(statm, " ", "");
+    if (pages.size() < 2)
+        return 0;
+
+    return pages[1].getLargeIntValue() * static_cast<int64>(sysconf(_SC_PAGESIZE));
+#elif JUCE_MAC
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+        return 0;
+
+    return static_cast<int64>(info.resident_size);
+#else
+    return 0;
+#endif
+}
+
+// Sends a 512 element list and a 4 element list to one of plugdata's receivers every millisecond
+inline String createMessageTrafficPatch()
+{
+    String patch;
+    patch << "#N canvas 0 0 450 300 12;\n";
+    patch << "#X obj 10 10 loadbang;\n";
+    patch << "#X obj 10 40 metro 1;\n";
+
+    patch << "#X msg 10 70";
+    for (int i = 0; i < 512; i++) {
+        patch << " " << i;
+    }
+    patch << ";\n";
+
+    patch << "#X msg 200 70 1 2 3 4;\n";
+    patch << "#X obj 10 100 s to_daw_databuffer;\n";
+    patch << "#X connect 0 0 1 0;\n#X connect 1 0 2 0;\n#X connect 1 0 3 0;\n#X connect 2 0 4 0;\n#X connect 3 0 4 0;\n";
+
+    return patch;
+}
+
+// A chain of control objects, like a big patch that mostly does message processing
+inline String createLargePatch(int numObjects)
+{
+    String patch;
+    patch << "#N canvas 0 0 450 300 12;\n";
+    for (int i = 0; i < numObjects; i++) {
+        patch << "#X obj " << (i % 40) * 60 << " " << (i / 40) * 30 << " + " << i << ";\n";
+    }
+    for (int i = 1; i < numObjects; i++) {
+        patch << "#X connect " << i - 1 << " 0 " << i << " 0;\n";
+    }
+
+    return patch;
+}
+
+// 400 objects with 16 outlets each, connected to the next 3 objects
+inline String createDensePatch()
+{
+    constexpr int numObjects = 400;
+    constexpr int numOutlets = 16;
+    constexpr int connectionsPerOutlet = 3;
+
+    String patch = "#N canvas 0 0 1000 1000 12;\n";
+    for (int i = 0; i < numObjects; i++) {
+        patch << "#X obj " << (i % 20) * 50 << " " << (i / 20) * 50 << " t" << String::repeatedString(" b", numOutlets) << ";\n";
+    }
+    for (int i = 0; i < numObjects; i++) {
+        for (int outlet = 0; outlet < numOutlets; outlet++) {
+            for (int j = 1; j <= connectionsPerOutlet; j++) {
+                patch << "#X connect " << i << " " << outlet << " " << (i + j) % numObjects << " 0;\n";
+            }
+        }
+    }
+
+    return patch;
+}
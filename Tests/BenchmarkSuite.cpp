@@ -0,0 +1,313 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+// Runs the hot paths of plugdata's Pd layer against a fixed corpus of generated patches, and writes the timings as JSON
+// A second mode compares two result files, and exits with an error code when the second one is slower
+// Usage: plugdata_benchmark_suite [--output results.json] [--iterations N]
+//        plugdata_benchmark_suite --compare baseline.json results.json [--threshold percent]
+
+#include "Utility/Config.h"
+#include "Pd/HeadlessInstance.h"
+#include "Pd/Library.h"
+#include "Pd/MessageListener.h"
+#include "Pd/Patch.h"
+
+#include "AllocationCounter.h"
+#include "BenchmarkPatches.h"
+
+#include <iostream>
+
+struct BenchmarkResult {
+    String name;
+    int iterations;
+    double median, p99; // In milliseconds
+    double allocations; // Per iteration
+};
+
+// Runs the function once to warm up, and then times every iteration separately
+static BenchmarkResult runBenchmark(String const& name, int iterations, std::function<void()> const& function)
+{
+    std::vector<double> times;
+    times.reserve(iterations);
+
+    function();
+
+    auto const allocationsBefore = numAllocations.load();
+    for (int i = 0; i < iterations; i++) {
+        auto const startTime = Time::getMillisecondCounterHiRes();
+        function();
+        times.push_back(Time::getMillisecondCounterHiRes() - startTime);
+    }
+    auto const allocations = static_cast<double>(numAllocations.load() - allocationsBefore) / iterations;
+
+    std::sort(times.begin(), times.end());
+    auto const median = times[times.size() / 2];
+    auto const p99 = times[std::min(times.size() - 1, static_cast<size_t>(times.size() * 0.99))];
+
+    // Progress goes to stderr, so the JSON on stdout stays clean
+    std::cerr << name << ": " << median << " ms median, " << p99 << " ms p99, " << allocations << " allocations" << std::endl;
+
+    return { name, iterations, median, p99, allocations };
+}
+
+// 64 oscillators with their own gain, mixed into the output
+static String createSynthPatch()
+{
+    constexpr int numVoices = 64;
+
+    String patch;
+    patch << "#N canvas 0 0 450 300 12;\n";
+    patch << "#X obj 10 10 dac~;\n";
+    for (int i = 0; i < numVoices; i++) {
+        patch << "#X obj " << (i % 16) * 60 << " " << 40 + (i / 16) * 90 << " osc~ " << 110 + i * 10 << ";\n";
+        patch << "#X obj " << (i % 16) * 60 << " " << 70 + (i / 16) * 90 << " *~ 0.01;\n";
+    }
+    for (int i = 0; i < numVoices; i++) {
+        patch << "#X connect " << 1 + i * 2 << " 0 " << 2 + i * 2 << " 0;\n";
+        patch << "#X connect " << 2 + i * 2 << " 0 0 " << i % 2 << ";\n";
+    }
+
+    return patch;
+}
+
+struct CountingListener : public pd::MessageListener {
+    void receiveMessage(t_symbol* symbol, pd::Atom const atoms[8], int numAtoms) override
+    {
+        numReceived++;
+    }
+
+    int numReceived = 0;
+};
+
+static std::vector<BenchmarkResult> runSuite(int iterations)
+{
+    constexpr double sampleRate = 44100.0;
+    constexpr int blockSize = 512;
+
+    std::vector<BenchmarkResult> results;
+
+    auto instance = std::make_unique<pd::HeadlessInstance>(2, 2, sampleRate);
+    instance->setThis();
+
+    std::vector<std::pair<String, String>> const corpus = {
+        { "message-traffic", createMessageTrafficPatch() },
+        { "synth", createSynthPatch() },
+        { "large", createLargePatch(5000) },
+        { "dense", createDensePatch() }
+    };
+
+    for (auto const& entry : corpus) {
+        auto const& content = entry.second;
+        results.push_back(runBenchmark("open/" + entry.first, std::max(1, iterations / 50), [&instance, &content]() {
+            instance->closePatch(instance->loadPatch(content));
+        }));
+    }
+
+    // One iteration is one block, so p99 shows how close we get to dropouts
+    AudioBuffer<float> buffer(2, blockSize);
+    MidiBuffer midi;
+    for (auto const& [name, content] : corpus) {
+        auto patch = instance->loadPatch(content);
+        results.push_back(runBenchmark("process/" + name, iterations, [&instance, &buffer, &midi]() {
+            buffer.clear();
+            midi.clear();
+            instance->process(buffer, midi);
+            instance->poll();
+        }));
+        instance->closePatch(patch);
+    }
+
+    // Messages from 64 objects, where each object gets a few updates per block
+    {
+        std::vector<int> targets(64);
+        std::vector<CountingListener> listeners(targets.size());
+        for (size_t i = 0; i < targets.size(); i++) {
+            instance->registerMessageListener(&targets[i], &listeners[i]);
+        }
+
+        auto* floatSymbol = gensym("float");
+        t_atom atom;
+        SETFLOAT(&atom, 1.0f);
+
+        results.push_back(runBenchmark("dispatch/1000-messages", iterations, [&instance, &targets, floatSymbol, &atom]() {
+            for (int i = 0; i < 1000; i++) {
+                instance->messageDispatcher->enqueueMessage(&targets[i % targets.size()], floatSymbol, 1, &atom);
+            }
+            instance->messageDispatcher->dequeueMessages();
+        }));
+
+        for (size_t i = 0; i < targets.size(); i++) {
+            instance->unregisterMessageListener(&targets[i], &listeners[i]);
+        }
+    }
+
+    {
+        auto patch = instance->loadPatch(String("#N canvas 0 0 450 300 12;\n#X obj 10 10 f;\n"));
+        auto* target = patch->getObjects()[0].getRawUnchecked<void>();
+
+        results.push_back(runBenchmark("send-direct-message/100-floats", iterations, [&instance, target]() {
+            for (int i = 0; i < 100; i++) {
+                instance->sendDirectMessage(target, static_cast<float>(i));
+            }
+        }));
+
+        results.push_back(runBenchmark("send-direct-message/100-lists", iterations, [&instance, target]() {
+            for (int i = 0; i < 100; i++) {
+                instance->sendDirectMessage(target, { pd::Atom(1.0f), pd::Atom(2.0f), pd::Atom(3.0f) });
+            }
+        }));
+
+        instance->closePatch(patch);
+    }
+
+    {
+        auto const largePatch = createLargePatch(1000);
+        results.push_back(runBenchmark("translate-patch/1000-objects", iterations, [&largePatch]() {
+            pd::Patch::translatePatchAsString(largePatch, { 100, 100 });
+        }));
+    }
+
+    {
+        auto& library = instance->getLibrary();
+        library.waitForInitialisationToFinish();
+
+        for (auto const* query : { "o", "osc", "list", "zzz" }) {
+            results.push_back(runBenchmark("autocomplete/" + String(query), iterations, [&library, query]() {
+                library.autocomplete(query, File());
+            }));
+        }
+    }
+
+    instance.reset();
+
+    return results;
+}
+
+static var toJSON(std::vector<BenchmarkResult> const& results)
+{
+    Array<var> benchmarks;
+    for (auto const& result : results) {
+        auto* benchmark = new DynamicObject();
+        benchmark->setProperty("name", result.name);
+        benchmark->setProperty("iterations", result.iterations);
+        benchmark->setProperty("median_ms", result.median);
+        benchmark->setProperty("p99_ms", result.p99);
+        benchmark->setProperty("allocations", result.allocations);
+        benchmarks.add(var(benchmark));
+    }
+
+    auto* root = new DynamicObject();
+    root->setProperty("version", ProjectInfo::versionString);
+    root->setProperty("date", Time::getCurrentTime().toISO8601(true));
+    root->setProperty("os", SystemStats::getOperatingSystemName());
+    root->setProperty("cpu", SystemStats::getCpuModel());
+    root->setProperty("benchmarks", benchmarks);
+    return var(root);
+}
+
+static std::map<String, BenchmarkResult> readResults(File const& file)
+{
+    std::map<String, BenchmarkResult> results;
+
+    auto const json = JSON::parse(file);
+    if (auto const* benchmarks = json["benchmarks"].getArray()) {
+        for (auto const& benchmark : *benchmarks) {
+            auto const name = benchmark["name"].toString();
+            results[name] = { name, static_cast<int>(benchmark["iterations"]), static_cast<double>(benchmark["median_ms"]), static_cast<double>(benchmark["p99_ms"]), static_cast<double>(benchmark["allocations"]) };
+        }
+    }
+
+    return results;
+}
+
+// A benchmark regressed if its median time or allocation count went up by more than the threshold
+// p99 is only reported, since it's too noisy on machines that aren't set up for benchmarking
+static int compareResults(File const& baselineFile, File const& resultFile, double threshold)
+{
+    auto const baseline = readResults(baselineFile);
+    auto const results = readResults(resultFile);
+
+    if (baseline.empty() || results.empty()) {
+        std::cerr << "Couldn't read benchmark results" << std::endl;
+        return 2;
+    }
+
+    // Timings this short are mostly noise
+    constexpr double minimumDifference = 0.001;
+
+    int numRegressions = 0;
+    for (auto const& [name, result] : results) {
+        auto const it = baseline.find(name);
+        if (it == baseline.end()) {
+            std::cout << "new:       " << name << std::endl;
+            continue;
+        }
+
+        auto const& base = it->second;
+        auto const medianChange = base.median > 0.0 ? (result.median / base.median - 1.0) * 100.0 : 0.0;
+        auto const p99Change = base.p99 > 0.0 ? (result.p99 / base.p99 - 1.0) * 100.0 : 0.0;
+
+        auto const slower = medianChange > threshold && result.median - base.median > minimumDifference;
+        auto const allocatesMore = result.allocations > base.allocations * (1.0 + threshold / 100.0) + 0.5;
+
+        if (slower || allocatesMore)
+            numRegressions++;
+
+        std::cout << (slower || allocatesMore ? "REGRESSED: " : "ok:        ") << name
+                  << ": median " << base.median << " -> " << result.median << " ms (" << String(medianChange, 1) << "%)"
+                  << ", p99 " << base.p99 << " -> " << result.p99 << " ms (" << String(p99Change, 1) << "%)"
+                  << ", allocations " << base.allocations << " -> " << result.allocations << std::endl;
+    }
+
+    for (auto const& [name, result] : baseline) {
+        if (!results.count(name))
+            std::cout << "missing:   " << name << std::endl;
+    }
+
+    std::cout << numRegressions << " regressions (threshold " << threshold << "%)" << std::endl;
+    return numRegressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; i++) {
+        args.add(String::fromUTF8(argv[i]));
+    }
+
+    auto const getOption = [&args](String const& name, String const& defaultValue) {
+        auto const index = args.indexOf(name);
+        return index >= 0 && index + 1 < args.size() ? args[index + 1] : defaultValue;
+    };
+
+    auto const workingDirectory = File::getCurrentWorkingDirectory();
+
+    int result = 0;
+    if (auto const compareIndex = args.indexOf("--compare"); compareIndex >= 0) {
+        if (compareIndex + 2 >= args.size()) {
+            std::cerr << "Usage: plugdata_benchmark_suite --compare baseline.json results.json [--threshold percent]" << std::endl;
+            return 2;
+        }
+
+        auto const threshold = getOption("--threshold", "10").getDoubleValue();
+        result = compareResults(workingDirectory.getChildFile(args[compareIndex + 1]), workingDirectory.getChildFile(args[compareIndex + 2]), threshold);
+    } else {
+        auto const iterations = std::max(10, getOption("--iterations", "500").getIntValue());
+        auto const json = JSON::toString(toJSON(runSuite(iterations)));
+
+        auto const output = getOption("--output", String());
+        if (output.isNotEmpty()) {
+            workingDirectory.getChildFile(output).replaceWithText(json);
+        } else {
+            std::cout << json << std::endl;
+        }
+    }
+
+    DeletedAtShutdown::deleteAll();
+    MessageManager::deleteInstance();
+
+    return result;
+}
@@ -0,0 +1,308 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+// Measures startup time, memory use, message throughput and MIDI timing of the headless Pd engine
+// Usage: plugdata_headless_benchmark [num-instances] [patch.pd]
+
+#include "Utility/Config.h"
+#include "Pd/HeadlessInstance.h"
+
+#include "AllocationCounter.h"
+#include "BenchmarkPatches.h"
+
+#include <iostream>
+#include <thread>
+
+// Note-ons drive two outputs: the left one delays each note by its offset from "midi_offset" with vline~, the right one jumps at the start of the pd block
+static String createMidiJitterPatch()
+{
+    String patch;
+    patch << "#N canvas 0 0 450 300 12;\n";
+    patch << "#X obj 10 10 notein;\n";
+    patch << "#X obj 200 10 r midi_offset;\n";
+    patch << "#X obj 10 40 / 127;\n";
+    patch << "#X obj 10 70 pack f f;\n";
+    patch << "#X msg 10 100 \\$1 0 \\$2;\n";
+    patch << "#X obj 10 130 vline~;\n";
+    patch << "#X obj 200 130 sig~;\n";
+    patch << "#X obj 10 160 dac~ 1 2;\n";
+    patch << "#X connect 0 1 2 0;\n#X connect 1 0 3 1;\n#X connect 2 0 3 0;\n#X connect 2 0 6 0;\n#X connect 3 0 4 0;\n#X connect 4 0 5 0;\n#X connect 5 0 7 0;\n#X connect 6 0 7 1;\n";
+
+    return patch;
+}
+
+static int findRisingEdge(float const* samples, int numSamples)
+{
+    for (int i = 0; i < numSamples; i++) {
+        if (samples[i] > 0.5f)
+            return i;
+    }
+    return -1;
+}
+
+static String formatMemory(int64 bytes)
+{
+    return String(static_cast<double>(bytes) / (1024.0 * 1024.0), 2) + " MB";
+}
+
+int main(int argc, char* argv[])
+{
+    int numInstances = argc > 1 ? std::max(1, String(argv[1]).getIntValue()) : 8;
+    auto patchFile = argc > 2 ? File::getCurrentWorkingDirectory().getChildFile(argv[2]) : File();
+
+    constexpr double sampleRate = 44100.0;
+    constexpr int blockSize = 512;
+
+    auto const baselineMemory = getResidentMemory();
+
+    std::vector<std::unique_ptr<pd::HeadlessInstance>> instances;
+
+    // The first instance also pays for loading Pd and its libraries
+    auto startTime = Time::getMillisecondCounterHiRes();
+    instances.push_back(std::make_unique<pd::HeadlessInstance>(2, 2, sampleRate));
+    auto const firstInstanceTime = Time::getMillisecondCounterHiRes() - startTime;
+    auto const firstInstanceMemory = getResidentMemory() - baselineMemory;
+
+    startTime = Time::getMillisecondCounterHiRes();
+    for (int i = 1; i < numInstances; i++) {
+        instances.push_back(std::make_unique<pd::HeadlessInstance>(2, 2, sampleRate));
+    }
+    auto const additionalInstanceTime = numInstances > 1 ? (Time::getMillisecondCounterHiRes() - startTime) / (numInstances - 1) : 0.0;
+    auto const additionalInstanceMemory = numInstances > 1 ? (getResidentMemory() - baselineMemory - firstInstanceMemory) / (numInstances - 1) : 0;
+
+    std::cout << "instances:                " << numInstances << std::endl;
+    std::cout << "first instance startup:   " << firstInstanceTime << " ms, " << formatMemory(firstInstanceMemory) << std::endl;
+    std::cout << "additional instance:      " << additionalInstanceTime << " ms, " << formatMemory(additionalInstanceMemory) << std::endl;
+
+    // Breakdown of the memory that plugdata allocates per instance, on top of what pd allocates
+    std::cout << "plugdata buffers and caches (partial, excludes pd and JUCE):" << std::endl;
+    auto const usage = instances[0]->getMemoryUsage();
+    for (auto const& [subsystem, bytes] : usage) {
+        std::cout << "  " << subsystem.toString() << ": " << formatMemory(static_cast<int64>(bytes)) << std::endl;
+    }
+
+    if (patchFile.existsAsFile()) {
+        startTime = Time::getMillisecondCounterHiRes();
+        for (auto& instance : instances) {
+            instance->loadPatch(patchFile);
+        }
+        std::cout << "patch open (per instance): " << (Time::getMillisecondCounterHiRes() - startTime) / numInstances << " ms" << std::endl;
+
+        // Compare against opening through the .pdc cache. The first open writes it, so it's left out
+        auto& instance = *instances[0];
+        instance.usePatchCache = true;
+        instance.closePatch(instance.loadPatch(patchFile));
+
+        startTime = Time::getMillisecondCounterHiRes();
+        instance.closePatch(instance.loadPatch(patchFile));
+        std::cout << "patch open (cached):      " << Time::getMillisecondCounterHiRes() - startTime << " ms" << std::endl;
+
+        instance.usePatchCache = false;
+        startTime = Time::getMillisecondCounterHiRes();
+        instance.closePatch(instance.loadPatch(patchFile));
+        std::cout << "patch open (uncached):    " << Time::getMillisecondCounterHiRes() - startTime << " ms" << std::endl;
+
+        // Restore a session of 16 patches, with an increasing number of threads for reading them
+        std::vector<pd::PatchLoader::Source> session(16, { String(), patchFile, false });
+        for (int numThreads = 1; numThreads <= SystemStats::getNumCpus(); numThreads *= 2) {
+            startTime = Time::getMillisecondCounterHiRes();
+
+            auto prepared = pd::PatchLoader::prepare(session, numThreads);
+
+            std::vector<pd::Patch::Ptr> opened;
+            instance.lockAudioThread();
+            for (auto& patch : prepared) {
+                opened.push_back(instance.openPatch(patch));
+            }
+            instance.unlockAudioThread();
+
+            std::cout << "session restore (" << numThreads << " threads): " << Time::getMillisecondCounterHiRes() - startTime << " ms" << std::endl;
+
+            instance.lockAudioThread();
+            opened.clear();
+            instance.unlockAudioThread();
+        }
+    }
+
+    AudioBuffer<float> buffer(2, blockSize);
+    MidiBuffer midi;
+
+    startTime = Time::getMillisecondCounterHiRes();
+    for (auto& instance : instances) {
+        for (int processed = 0; processed < static_cast<int>(sampleRate); processed += blockSize) {
+            buffer.clear();
+            instance->process(buffer, midi);
+            instance->poll();
+        }
+    }
+    std::cout << "1s of audio (per instance): " << (Time::getMillisecondCounterHiRes() - startTime) / numInstances << " ms" << std::endl;
+
+    // Messages from pd to plugdata's receivers are created on the audio thread and handled in poll()
+    {
+        auto& instance = *instances[0];
+        auto trafficPatch = instance.loadPatch(createMessageTrafficPatch());
+
+        constexpr int numSeconds = 10;
+        auto const allocationsBefore = numAllocations.load();
+        startTime = Time::getMillisecondCounterHiRes();
+        for (int processed = 0; processed < static_cast<int>(sampleRate) * numSeconds; processed += blockSize) {
+            buffer.clear();
+            instance.process(buffer, midi);
+            instance.poll();
+        }
+        auto const trafficTime = Time::getMillisecondCounterHiRes() - startTime;
+        auto const allocationsPerSecond = (numAllocations.load() - allocationsBefore) / numSeconds;
+
+        std::cout << "message traffic (2000 lists/s): " << trafficTime / numSeconds << " ms per second of audio, " << allocationsPerSecond << " allocations per second" << std::endl;
+
+        instance.closePatch(trafficPatch);
+    }
+
+    // MIDI arrives at random positions within each buffer, and we compare where the notes come out with where they went in
+    {
+        auto& instance = *instances[0];
+        auto jitterPatch = instance.loadPatch(createMidiJitterPatch());
+
+        Random random(42);
+        MidiBuffer events;
+        int numNotes = 0;
+        double offsetError = 0.0, blockError = 0.0;
+        int maxOffsetError = 0, maxBlockError = 0;
+
+        for (int i = 0; i < 2000; i++) {
+            auto const position = random.nextInt(blockSize);
+            auto const isNoteOn = (i % 2) == 0;
+
+            events.clear();
+            events.addEvent(isNoteOn ? MidiMessage::noteOn(1, 60, static_cast<uint8>(127)) : MidiMessage::noteOff(1, 60), position);
+            midi.clear();
+            midi.addEvents(events, 0, blockSize, 0);
+
+            buffer.clear();
+            instance.process(buffer, midi);
+            instance.poll();
+
+            if (!isNoteOn)
+                continue;
+
+            auto const withOffset = findRisingEdge(buffer.getReadPointer(0), blockSize);
+            auto const withoutOffset = findRisingEdge(buffer.getReadPointer(1), blockSize);
+            if (withOffset < 0 || withoutOffset < 0)
+                continue;
+
+            offsetError += std::abs(withOffset - position);
+            blockError += std::abs(withoutOffset - position);
+            maxOffsetError = std::max(maxOffsetError, std::abs(withOffset - position));
+            maxBlockError = std::max(maxBlockError, std::abs(withoutOffset - position));
+            numNotes++;
+        }
+
+        if (numNotes > 0) {
+            std::cout << "midi jitter (midi_offset): " << offsetError / numNotes << " samples average, " << maxOffsetError << " max" << std::endl;
+            std::cout << "midi jitter (block start): " << blockError / numNotes << " samples average, " << maxBlockError << " max" << std::endl;
+        }
+
+        instance.closePatch(jitterPatch);
+    }
+
+    // A dense stream of controller changes, once with nothing listening for MIDI and once with [ctlin] and [midiin]
+    {
+        auto& instance = *instances[0];
+
+        constexpr int eventsPerBuffer = 256;
+        MidiBuffer events;
+        for (int i = 0; i < eventsPerBuffer; i++) {
+            events.addEvent(MidiMessage::controllerEvent(1 + (i % 16), i % 128, i % 128), (i * blockSize) / eventsPerBuffer);
+        }
+
+        auto const measureThroughput = [&]() {
+            auto const start = Time::getMillisecondCounterHiRes();
+            for (int processed = 0; processed < static_cast<int>(sampleRate); processed += blockSize) {
+                midi.clear();
+                midi.addEvents(events, 0, blockSize, 0);
+                buffer.clear();
+                instance.process(buffer, midi);
+            }
+            return Time::getMillisecondCounterHiRes() - start;
+        };
+
+        auto const eventsPerSecond = eventsPerBuffer * static_cast<int>(sampleRate) / blockSize;
+        std::cout << "midi throughput (" << eventsPerSecond << " events/s, no receivers): " << measureThroughput() << " ms per second of audio" << std::endl;
+
+        auto receiverPatch = instance.loadPatch(String("#N canvas 0 0 450 300 12;\n#X obj 10 10 ctlin;\n#X obj 10 40 midiin;\n"));
+        std::cout << "midi throughput (" << eventsPerSecond << " events/s, ctlin + midiin): " << measureThroughput() << " ms per second of audio" << std::endl;
+        instance.closePatch(receiverPatch);
+        instance.poll();
+    }
+
+    // Saving a large patch to a slow disk, while another thread processes audio
+    // The write happens on the PatchWriter thread, so the audio thread should only have to wait for the patch to be serialised
+    // The patch is edited while the write is pending, which should leave it dirty once the write finishes
+    {
+        auto& instance = *instances[0];
+        auto largePatch = instance.loadPatch(createLargePatch(5000));
+        auto saveFile = File::createTempFile(".pd");
+
+        // The old writer finishes anything it still has queued when it's destroyed
+        instance.patchWriter = std::make_unique<pd::PatchWriter>([](File const& file, std::string const& content) {
+            Thread::sleep(500);
+            return pd::PatchWriter::writeToFile(file, content);
+        });
+
+        std::atomic<bool> isSaving = true;
+        std::atomic<double> maxLockWait = 0.0;
+        std::thread audioThread([&instance, &isSaving, &maxLockWait]() {
+            AudioBuffer<float> audioBuffer(2, pd::Instance::getBlockSize());
+            MidiBuffer audioMidi;
+            while (isSaving) {
+                auto const waitStart = Time::getMillisecondCounterHiRes();
+                instance.lockAudioThread();
+                auto const lockWait = Time::getMillisecondCounterHiRes() - waitStart;
+                audioBuffer.clear();
+                instance.process(audioBuffer, audioMidi);
+                instance.unlockAudioThread();
+
+                maxLockWait = std::max(maxLockWait.load(), lockWait);
+                Thread::sleep(1);
+            }
+        });
+
+        startTime = Time::getMillisecondCounterHiRes();
+        largePatch->savePatch(URL(saveFile));
+        auto const saveCallTime = Time::getMillisecondCounterHiRes() - startTime;
+
+        // An edit made while the file is being written isn't in it, so it has to keep the patch dirty
+        instance.lockAudioThread();
+        largePatch->moveObjects({ largePatch->getPointer()->gl_list }, 10, 0);
+        instance.unlockAudioThread();
+
+        instance.patchWriter->waitForPendingWrites();
+        auto const writeTime = Time::getMillisecondCounterHiRes() - startTime;
+
+        isSaving = false;
+        audioThread.join();
+
+        // Lets the "saved to" callback run, which needs the message thread
+        MessageManager::getInstance()->runDispatchLoopUntil(50);
+        instance.poll();
+
+        std::cout << "patch save (5000 objects, 500 ms disk): " << saveCallTime << " ms blocking, " << writeTime << " ms until written, " << maxLockWait.load() << " ms max audio thread wait" << std::endl;
+        std::cout << "patch dirty after an edit during the save: " << (largePatch->getPointer()->gl_dirty ? "yes" : "NO") << std::endl;
+
+        instance.patchWriter = std::make_unique<pd::PatchWriter>();
+        instance.closePatch(largePatch);
+        saveFile.deleteFile();
+    }
+
+    std::cout << "total resident memory:    " << formatMemory(getResidentMemory()) << std::endl;
+
+    instances.clear();
+
+    DeletedAtShutdown::deleteAll();
+    MessageManager::deleteInstance();
+
+    return 0;
+}
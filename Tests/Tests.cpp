@@ -5,8 +5,87 @@
 #include "Sidebar/Sidebar.h" // So we can read and clear the console
 #include "Objects/ObjectBase.h" // So we can interact with object GUIs
 #include "PluginEditor.h"
+#include "PluginProcessor.h"
+#include "Connection.h"
+#include "Iolet.h"
+#include "CanvasViewport.h"
+#include "Sidebar/AutomationPanel.h"
+#include "Utility/MidiInputRing.h"
+#include "Utility/ThreadSafeStack.h"
+#include "Pd/PatchCache.h"
+
+extern "C" {
+#include <g_canvas.h>
+}
+#include "Standalone/PlugDataWindow.h"
+
+#include "BenchmarkPatches.h"
+
+#include <thread>
 
 String loggedErrors;
+int numFailedChecks = 0;
+
+// Prints and counts a failed check, the test run only completes successfully if every check passed
+bool expect(bool condition, String const& description)
+{
+    if (!condition) {
+        std::cout << "CHECK FAILED: " << description << std::endl;
+        numFailedChecks++;
+    }
+
+    return condition;
+}
+
+// Checks that the connection lists kept by the iolets match the connections on the canvas, and are in the same order
+bool checkConnectionIndex(Canvas* cnv)
+{
+    std::unordered_map<Connection*, int> canvasIndices;
+    for (int i = 0; i < cnv->connections.size(); i++) {
+        canvasIndices[cnv->connections[i]] = i;
+    }
+
+    int numConnectionEnds = 0;
+    for (auto* object : cnv->objects) {
+        for (auto* iolet : object->iolets) {
+            int lastIndex = -1;
+            for (auto* connection : iolet->getConnections()) {
+                auto const canvasIndex = canvasIndices.find(connection);
+                if (canvasIndex == canvasIndices.end() || (connection->inlet != iolet && connection->outlet != iolet)) {
+                    std::cout << "CONNECTION INDEX CONTAINS STALE CONNECTION: " << cnv->patch.getTitle() << std::endl;
+                    return false;
+                }
+
+                // The multi-connect numbers come from this order
+                auto const index = canvasIndex->second;
+                if (index < lastIndex) {
+                    std::cout << "CONNECTION INDEX IS OUT OF ORDER: " << cnv->patch.getTitle() << std::endl;
+                    return false;
+                }
+                lastIndex = index;
+            }
+            numConnectionEnds += iolet->getNumConnections();
+        }
+    }
+
+    for (auto* connection : cnv->connections) {
+        if (!connection->inlet || !connection->outlet)
+            continue;
+
+        if (!connection->inlet->getConnections().contains(connection) || !connection->outlet->getConnections().contains(connection)) {
+            std::cout << "CONNECTION INDEX IS MISSING CONNECTION: " << cnv->patch.getTitle() << std::endl;
+            return false;
+        }
+        numConnectionEnds -= 2;
+    }
+
+    if (numConnectionEnds != 0) {
+        std::cout << "CONNECTION INDEX CONTAINS DUPLICATES: " << cnv->patch.getTitle() << std::endl;
+        return false;
+    }
+
+    return true;
+}
 
 void openHelpfilesRecursively(TabComponent& tabbar, std::vector<File>& helpFiles)
 {
@@ -14,7 +93,10 @@ void openHelpfilesRecursively(TabComponent& tabbar, std::vector<File>& helpFiles
     
     if(helpFiles.empty())
     {
-        std::cout << "TEST COMPLETED SUCCESFULLY" << std::endl;
+        if (numFailedChecks > 0)
+            std::cout << "TEST FAILED: " << numFailedChecks << " CHECKS FAILED" << std::endl;
+        else
+            std::cout << "TEST COMPLETED SUCCESFULLY" << std::endl;
         ProjectInfo::appDataDir.getChildFile("console-errors.md").replaceWithText(loggedErrors);
         return;
     }
@@ -29,6 +111,15 @@ void openHelpfilesRecursively(TabComponent& tabbar, std::vector<File>& helpFiles
     auto* pd = cnv->pd;
     auto* editor = cnv->editor;
 
+    // Everything after this would work on connections the canvas doesn't know about, so skip to the next helpfile
+    if (!expect(checkConnectionIndex(cnv), "connection index of " + helpFile.getFullPathName())) {
+        while (auto* openCanvas = tabbar.getCurrentCanvas()) {
+            tabbar.closeTab(openCanvas);
+        }
+        MessageManager::callAsync([&tabbar, &helpFiles]() { openHelpfilesRecursively(tabbar, helpFiles); });
+        return;
+    }
+
     // Evil test that deletes the patch instantly after being created, leaving dangling pointers everywhere
     // plugdata should be able to handle that!
 #define TEST_PATCH_DETACHED 0
@@ -106,8 +197,1145 @@ void openHelpfilesRecursively(TabComponent& tabbar, std::vector<File>& helpFiles
     });
 }
 
+// Measures how long it takes a host to construct and destroy plugin instances, like it would during a plugin scan or project load
+void benchmarkInstantiation(int numInstances)
+{
+    std::vector<std::unique_ptr<PluginProcessor>> instances;
+
+    auto startTime = Time::getMillisecondCounterHiRes();
+    for (int i = 0; i < numInstances; i++) {
+        instances.push_back(std::make_unique<PluginProcessor>());
+    }
+    auto constructionTime = Time::getMillisecondCounterHiRes() - startTime;
+
+    startTime = Time::getMillisecondCounterHiRes();
+    instances.clear();
+    auto destructionTime = Time::getMillisecondCounterHiRes() - startTime;
+
+    std::cout << "CONSTRUCTED " << numInstances << " INSTANCES: " << constructionTime << " ms (" << constructionTime / numInstances << " ms per instance)" << std::endl;
+    std::cout << "DESTROYED " << numInstances << " INSTANCES: " << destructionTime << " ms" << std::endl;
+}
+
+// Creates a directory with an abstraction that has comments on its two inlets and its outlet
+File createTooltipAbstraction(String const& directoryName)
+{
+    auto directory = File::getSpecialLocation(File::tempDirectory).getChildFile(directoryName);
+    directory.createDirectory();
+
+    directory.getChildFile("tooltip-abstraction.pd").replaceWithText("#N canvas 0 0 400 300 12;\n"
+                                                                     "#X obj 20 20 inlet left input;\n"
+                                                                     "#X obj 120 20 inlet~ right input;\n"
+                                                                     "#X obj 20 200 outlet result;\n"
+                                                                     "#X connect 0 0 2 0;\n");
+    return directory;
+}
+
+// Checks that the iolet tooltips of an abstraction come from the comments on its inlets and outlets, and that subpatches find their gemlist iolets right away
+void testAbstractionTooltips(TabComponent& tabbar)
+{
+    auto directory = createTooltipAbstraction("plugdata-tooltip-test");
+    auto patchFile = directory.getChildFile("tooltip-test.pd");
+    patchFile.replaceWithText("#N canvas 0 0 1000 1000 12;\n#X obj 20 20 tooltip-abstraction;\n");
+
+    auto* cnv = tabbar.openPatch(URL(patchFile));
+
+    auto* abstraction = cnv->objects.getFirst();
+    expect(abstraction && abstraction->iolets.size() == 3, "abstraction has two inlets and one outlet");
+    if (abstraction && abstraction->iolets.size() == 3) {
+        expect(abstraction->iolets[0]->getTooltip() == "left input", "abstraction inlet tooltip comes from its comment");
+        expect(abstraction->iolets[1]->getTooltip() == "right input", "abstraction signal inlet tooltip comes from its comment");
+        expect(abstraction->iolets[2]->getTooltip() == "result", "abstraction outlet tooltip comes from its comment");
+    }
+
+    tabbar.closeTab(cnv);
+    directory.deleteRecursively();
+
+    // Gemlist iolets change how connections are drawn, so a subpatch has to know about them before anything is hovered
+    cnv = tabbar.openPatch("#N canvas 0 0 1000 1000 12;\n#N canvas 0 0 400 300 sub 0;\n#X obj 20 20 inlet (gemlist);\n#X obj 20 200 outlet;\n#X restore 20 20 pd sub;\n");
+
+    auto* subpatch = cnv->objects.getFirst();
+    if (expect(subpatch && subpatch->iolets.size() == 2, "subpatch has one inlet and one outlet")) {
+        expect(subpatch->iolets[0]->isGemState, "subpatch inlet with a gemlist comment is a gem iolet without hovering");
+        expect(!subpatch->iolets[1]->isGemState, "subpatch outlet without a comment is not a gem iolet");
+    }
+
+    tabbar.closeTab(cnv);
+}
+
+// Measures opening a patch with 1000 documented objects and 500 instances of one abstraction
+// Tooltips are looked up on first hover, resolving all of them afterwards shows what opening used to cost on top
+void benchmarkPatchOpening(TabComponent& tabbar)
+{
+    auto directory = createTooltipAbstraction("plugdata-tooltip-benchmark");
+
+    String patch = "#N canvas 0 0 1000 1000 12;\n";
+    for (int i = 0; i < 1500; i++) {
+        auto type = i < 500 ? String("tooltip-abstraction") : StringArray { "osc~ 440", "+ 1", "metro 100", "pack f f", "t b b b" }[i % 5];
+        patch += "#X obj " + String((i % 30) * 60) + " " + String((i / 30) * 40) + " " + type + ";\n";
+    }
+
+    auto patchFile = directory.getChildFile("tooltip-benchmark.pd");
+    patchFile.replaceWithText(patch);
+
+    auto startTime = Time::getMillisecondCounterHiRes();
+    auto* cnv = tabbar.openPatch(URL(patchFile));
+    auto openTime = Time::getMillisecondCounterHiRes() - startTime;
+
+    startTime = Time::getMillisecondCounterHiRes();
+    for (auto* object : cnv->objects) {
+        object->resolveTooltips();
+    }
+    auto resolveTime = Time::getMillisecondCounterHiRes() - startTime;
+
+    std::cout << "OPEN PATCH WITH " << cnv->objects.size() << " OBJECTS: " << openTime << " ms, resolving all tooltips: " << resolveTime << " ms" << std::endl;
+
+    tabbar.closeTab(cnv);
+    directory.deleteRecursively();
+}
+
+// Measures construction time and memory per object, for a canvas with 10000 objects of common types
+void benchmarkObjectFootprint(TabComponent& tabbar)
+{
+    constexpr int numObjects = 10000;
+    StringArray const types = { "+ 1", "f", "tgl", "hsl", "bng", "nbx", "msg", "floatatom" };
+
+    String patch = "#N canvas 0 0 1000 1000 12;\n";
+    for (int i = 0; i < numObjects; i++) {
+        auto const& type = types[i % types.size()];
+        auto const position = String((i % 100) * 60) + " " + String((i / 100) * 40);
+        if (type == "msg" || type == "floatatom")
+            patch += "#X " + type + " " + position + (type == "msg" ? " bang" : " 5 0 0 0 - - - 0") + ";\n";
+        else
+            patch += "#X obj " + position + " " + type + ";\n";
+    }
+
+    auto const memoryBefore = getResidentMemory();
+    auto startTime = Time::getMillisecondCounterHiRes();
+    auto* cnv = tabbar.openPatch(patch);
+    auto const constructionTime = Time::getMillisecondCounterHiRes() - startTime;
+    auto const memoryAfter = getResidentMemory();
+
+    std::cout << "CONSTRUCTED " << cnv->objects.size() << " OBJECTS: " << constructionTime << " ms (" << constructionTime * 1000.0 / numObjects << " us per object)" << std::endl;
+    if (memoryBefore > 0)
+        std::cout << "OBJECT FOOTPRINT: " << (memoryAfter - memoryBefore) / numObjects << " bytes per object, including pd" << std::endl;
+
+    tabbar.closeTab(cnv);
+}
+
+// Measures frame times while panning across a dense canvas, one frame per scroll step
+void benchmarkPanning(TabComponent& tabbar)
+{
+    auto* cnv = tabbar.openPatch(createDensePatch());
+    auto& surface = cnv->editor->nvgSurface;
+
+    surface.render(); // Render the first frame in full, so we only measure scrolling
+
+    double totalTime = 0.0, maxTime = 0.0;
+    constexpr int numFrames = 240;
+    for (int frame = 0; frame < numFrames; frame++) {
+        auto direction = frame < numFrames / 2 ? 1 : -1;
+        cnv->viewport->setViewPosition(cnv->viewport->getViewPosition() + Point<int>(3, 2) * direction);
+
+        auto startTime = Time::getMillisecondCounterHiRes();
+        surface.render();
+        auto frameTime = Time::getMillisecondCounterHiRes() - startTime;
+
+        totalTime += frameTime;
+        maxTime = std::max(maxTime, frameTime);
+    }
+    std::cout << "PAN " << numFrames << " FRAMES: " << totalTime / numFrames << " ms average, " << maxTime << " ms max" << std::endl;
+
+    tabbar.closeTab(cnv);
+}
+
+// Measures frame times during a zoom gesture, which is drawn from a scaled snapshot until it settles
+void benchmarkZooming(TabComponent& tabbar)
+{
+    auto* cnv = tabbar.openPatch(createDensePatch());
+    auto* viewport = dynamic_cast<CanvasViewport*>(cnv->viewport.get());
+    auto& surface = cnv->editor->nvgSurface;
+
+    surface.render();
+    surface.startFrameTrace();
+
+    for (int step = 0; step < 60; step++) {
+        viewport->magnify(step < 30 ? 1.0f - step * 0.02f : 0.42f + (step - 30) * 0.04f);
+        surface.render();
+    }
+
+    viewport->timerCallback(); // End the zoom gesture
+    surface.render();
+
+    auto trace = surface.stopFrameTrace();
+    double interimTime = 0.0, settleTime = 0.0;
+    int numInterimFrames = 0;
+    for (auto& frame : trace) {
+        if (frame.isInterimZoomFrame) {
+            interimTime += frame.renderTime;
+            numInterimFrames++;
+        } else {
+            settleTime = frame.renderTime;
+        }
+    }
+
+    std::cout << "ZOOM " << numInterimFrames << " INTERIM FRAMES: " << interimTime / std::max(1, numInterimFrames) << " ms average, " << settleTime << " ms for the final frame" << std::endl;
+
+    tabbar.closeTab(cnv);
+}
+
+// Checks that a hidden editor doesn't render, and renders exactly one frame when it becomes visible again
+void testSuspendAndResume(PluginEditor* editor)
+{
+    auto* cnv = editor->getTabComponent().openPatch(createDensePatch());
+    auto& surface = editor->nvgSurface;
+    surface.render();
+
+    editor->setVisible(false);
+    surface.startFrameTrace();
+    cnv->repaint();
+    for (int frame = 0; frame < 10; frame++) {
+        surface.render();
+    }
+    expect(surface.stopFrameTrace().empty(), "hidden editor doesn't render");
+
+    editor->setVisible(true);
+    surface.startFrameTrace();
+    surface.render();
+    surface.render();
+    expect(surface.stopFrameTrace().size() == 1, "editor renders exactly one frame after becoming visible");
+
+    editor->getTabComponent().closeTab(cnv);
+}
+
+// Measures the cost of a vblank where nothing changed, with numEditors editors open, and with all of them hidden
+// The extra editors get their own window, so they're really showing, just like a patch that was dragged out of the tab bar
+void benchmarkIdleFrames(PluginEditor* editor, int numEditors)
+{
+    auto* pd = editor->pd;
+    Array<PluginEditor*> editors = { editor };
+    Array<Canvas*> canvases = { editor->getTabComponent().openPatch(createDensePatch()) };
+
+    while (editors.size() < numEditors) {
+        auto* newEditor = new PluginEditor(*pd);
+        auto* newWindow = ProjectInfo::createNewWindow(newEditor);
+        if (!newWindow) { // Only the standalone app can open more windows
+            delete newEditor;
+            break;
+        }
+
+        pd->openedEditors.add(newEditor);
+        newWindow->addToDesktop(newWindow->getDesktopWindowStyleFlags());
+        newWindow->setVisible(true);
+
+        editors.add(newEditor);
+        canvases.add(newEditor->getTabComponent().openPatch(createDensePatch()));
+    }
+
+    auto renderAll = [&editors]() {
+        for (auto* openEditor : editors) {
+            openEditor->nvgSurface.render();
+        }
+    };
+
+    renderAll();
+
+    auto measureFrames = [&renderAll]() {
+        constexpr int numFrames = 1000;
+        auto startTime = Time::getMillisecondCounterHiRes();
+        for (int frame = 0; frame < numFrames; frame++) {
+            renderAll();
+        }
+        return (Time::getMillisecondCounterHiRes() - startTime) * 1000.0 / numFrames;
+    };
+
+    auto const idleFrameTime = measureFrames();
+
+    for (int i = 0; i < editors.size(); i++) {
+        editors[i]->setVisible(false);
+        canvases[i]->repaint();
+    }
+    auto const suspendedFrameTime = measureFrames();
+    for (auto* openEditor : editors) {
+        openEditor->setVisible(true);
+    }
+
+    std::cout << "IDLE VBLANK WITH " << editors.size() << " EDITORS OPEN: " << idleFrameTime << " us (" << idleFrameTime / editors.size() << " us per editor)" << std::endl;
+    std::cout << "SUSPENDED VBLANK WITH " << editors.size() << " EDITORS HIDDEN: " << suspendedFrameTime << " us (" << suspendedFrameTime / editors.size() << " us per editor)" << std::endl;
+
+    for (int i = editors.size() - 1; i >= 0; i--) {
+        editors[i]->getTabComponent().closeTab(canvases[i]);
+        if (editors[i] != editor) {
+            editors[i]->nvgSurface.detachContext();
+            pd->openedEditors.removeObject(editors[i]); // This also closes its window
+        }
+    }
+}
+
+// Checks that the connection index on the iolets stays in sync when deleting objects, and when undoing and redoing that
+void testConnectionIndex(TabComponent& tabbar)
+{
+    auto* cnv = tabbar.openPatch(createDensePatch());
+
+    // Each step builds on the previous one, so stop at the first mismatch
+    auto const checkStep = [cnv](auto const& step, String const& description) {
+        step();
+        cnv->performSynchronise();
+        return expect(checkConnectionIndex(cnv), "connection index after " + description);
+    };
+
+    for (int i = 0; i < 16; i++) {
+        cnv->setSelected(cnv->objects[i], true, false);
+    }
+
+    auto indexIsValid = expect(checkConnectionIndex(cnv), "connection index after opening");
+    indexIsValid = indexIsValid && checkStep([cnv]() { cnv->removeSelection(); }, "deleting objects");
+    indexIsValid = indexIsValid && checkStep([cnv]() { cnv->undo(); }, "undo");
+    indexIsValid = indexIsValid && checkStep([cnv]() { cnv->redo(); }, "redo");
+
+    tabbar.closeTab(cnv);
+}
+
+// Measures dragging, synchronising, routing and deleting on a canvas with a lot of connections
+void benchmarkConnections(TabComponent& tabbar)
+{
+    auto* cnv = tabbar.openPatch(createDensePatch());
+    std::cout << "CONNECTIONS: " << cnv->connections.size() << std::endl;
+
+    // A drag updates the connections of every dragged object for each mouse event
+    auto startTime = Time::getMillisecondCounterHiRes();
+    int numVisited = 0;
+    for (int event = 0; event < 100; event++) {
+        for (int i = 0; i < 16; i++) {
+            numVisited += cnv->objects[i]->getConnections().size();
+        }
+    }
+    std::cout << "DRAG 16 OBJECTS, 100 EVENTS: " << Time::getMillisecondCounterHiRes() - startTime << " ms (" << numVisited << " connections visited)" << std::endl;
+
+    // Nothing changed in pd, so this is the cost of comparing every object and connection with the patch
+    constexpr int numSynchronises = 10;
+    startTime = Time::getMillisecondCounterHiRes();
+    for (int i = 0; i < numSynchronises; i++) {
+        cnv->performSynchronise();
+    }
+    std::cout << "SYNCHRONISE " << cnv->objects.size() << " OBJECTS: " << (Time::getMillisecondCounterHiRes() - startTime) / numSynchronises << " ms" << std::endl;
+
+    // Routes connections around the objects between their ends, like a segmented connection without a stored path
+    auto const numRouted = std::min(100, cnv->connections.size());
+    startTime = Time::getMillisecondCounterHiRes();
+    for (int i = 0; i < numRouted; i++) {
+        cnv->connections[i]->findPath();
+    }
+    std::cout << "FIND PATH FOR " << numRouted << " CONNECTIONS: " << Time::getMillisecondCounterHiRes() - startTime << " ms" << std::endl;
+
+    for (int i = 0; i < 16; i++) {
+        cnv->setSelected(cnv->objects[i], true, false);
+    }
+
+    startTime = Time::getMillisecondCounterHiRes();
+    cnv->removeSelection();
+    cnv->performSynchronise();
+    std::cout << "DELETE 16 OBJECTS: " << Time::getMillisecondCounterHiRes() - startTime << " ms" << std::endl;
+
+    tabbar.closeTab(cnv);
+}
+
+MouseEvent createFakeMouseEvent(Component* component, Point<float> position, Point<float> mouseDownPosition)
+{
+    auto mms = Desktop::getInstance().getMainMouseSource();
+    return MouseEvent(mms, position, ModifierKeys::leftButtonModifier, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, component, component, Time::getCurrentTime(), mouseDownPosition, Time::getCurrentTime(), 1, position != mouseDownPosition);
+}
+
+// Drags across a component with 16 mouse events per frame, like a 1000 Hz mouse on a 60 Hz display
+// Returns the average and the longest frame time
+std::pair<double, double> simulateFastDrag(Canvas* cnv, Component* target, Point<float> start, Point<float> distance)
+{
+    constexpr int numFrames = 60;
+    constexpr int eventsPerFrame = 16;
+    auto& surface = cnv->editor->nvgSurface;
+
+    target->mouseDown(createFakeMouseEvent(target, start, start));
+
+    double totalTime = 0.0, maxTime = 0.0;
+    for (int frame = 0; frame < numFrames; frame++) {
+        auto startTime = Time::getMillisecondCounterHiRes();
+        for (int event = 1; event <= eventsPerFrame; event++) {
+            auto progress = static_cast<float>(frame * eventsPerFrame + event) / (numFrames * eventsPerFrame);
+            target->mouseDrag(createFakeMouseEvent(target, start + distance * progress, start));
+        }
+        cnv->inputCoalescer.flush(); // This is what the vblank callback would do
+        surface.render();
+        auto frameTime = Time::getMillisecondCounterHiRes() - startTime;
+
+        totalTime += frameTime;
+        maxTime = std::max(maxTime, frameTime);
+    }
+
+    target->mouseUp(createFakeMouseEvent(target, start + distance, start));
+
+    return { totalTime / numFrames, maxTime };
+}
+
+// Checks that a fast slider drag only reaches pd about once per frame, and that the last position of the drag isn't lost
+void testInputCoalescing(TabComponent& tabbar)
+{
+    auto* cnv = tabbar.openPatch("#N canvas 0 0 1000 1000 12;\n#X obj 20 20 hsl 400 15 0 127 0 0 empty empty empty -2 -8 0 10 #fcfcfc #000000 #000000 0 1;\n");
+    cnv->locked.setValue(true);
+
+    auto* object = cnv->objects.getFirst();
+    auto* slider = object && object->gui ? dynamic_cast<Slider*>(object->gui->getChildComponent(0)) : nullptr;
+    if (expect(slider != nullptr, "slider object has a slider component")) {
+        cnv->inputCoalescer.setEnabled(true);
+        cnv->inputCoalescer.resetCounters();
+
+        auto bounds = slider->getLocalBounds().toFloat();
+        simulateFastDrag(cnv, slider, bounds.getCentre().withX(bounds.getX() + 2.0f), { bounds.getWidth() - 4.0f, 0.0f });
+
+        expect(cnv->inputCoalescer.getNumApplied() < cnv->inputCoalescer.getNumReceived() / 4, "coalesced drag applies fewer events than it receives");
+        expect(slider->getValue() > slider->getMaximum() * 0.95, "coalesced drag ends at the last mouse position");
+
+        // A pending drag refers to the component it came from, so it must not be applied once that's gone
+        auto source = std::make_unique<Component>();
+        cnv->inputCoalescer.resetCounters();
+        cnv->inputCoalescer.coalesceDrag(slider, createFakeMouseEvent(source.get(), {}, {}));
+        source.reset();
+        cnv->inputCoalescer.flush();
+        expect(cnv->inputCoalescer.getNumApplied() == 0, "coalesced drag from a deleted component is dropped");
+    }
+
+    tabbar.closeTab(cnv);
+}
+
+// Measures how many drag events reach pd, and the frame times, during fast drags of sliders and of a group of objects
+// Every drag is done once with each mouse event applied right away, and once with input coalesced per frame
+void benchmarkDragging(TabComponent& tabbar)
+{
+    String sliderPatch = "#N canvas 0 0 1000 1000 12;\n";
+    for (int i = 0; i < 16; i++) {
+        sliderPatch += "#X obj 20 " + String(20 + i * 30) + " hsl 400 15 0 127 0 0 empty empty empty -2 -8 0 10 #fcfcfc #000000 #000000 0 1;\n";
+    }
+
+    auto* sliderCanvas = tabbar.openPatch(sliderPatch);
+    auto* objectCanvas = tabbar.openPatch(createDensePatch());
+    sliderCanvas->locked.setValue(true);
+
+    for (int i = 0; i < 16; i++) {
+        objectCanvas->setSelected(objectCanvas->objects[i], true, false);
+    }
+
+    for (auto coalesced : { false, true }) {
+        String const mode = coalesced ? "COALESCED" : "IMMEDIATE";
+
+        sliderCanvas->inputCoalescer.setEnabled(coalesced);
+        sliderCanvas->inputCoalescer.resetCounters();
+
+        double totalTime = 0.0, maxTime = 0.0;
+        for (auto* object : sliderCanvas->objects) {
+            auto* slider = object->gui ? dynamic_cast<Slider*>(object->gui->getChildComponent(0)) : nullptr;
+            if (!slider)
+                continue;
+
+            auto bounds = slider->getLocalBounds().toFloat();
+            auto [averageTime, longestTime] = simulateFastDrag(sliderCanvas, slider, bounds.getCentre().withX(bounds.getX() + 2.0f), { bounds.getWidth() - 4.0f, 0.0f });
+            totalTime += averageTime;
+            maxTime = std::max(maxTime, longestTime);
+        }
+        std::cout << "SLIDER DRAG " << mode << ": " << sliderCanvas->inputCoalescer.getNumReceived() << " VALUES, " << sliderCanvas->inputCoalescer.getNumApplied() << " SENT TO PD, " << totalTime / 16.0 << " ms average, " << maxTime << " ms max" << std::endl;
+
+        objectCanvas->inputCoalescer.setEnabled(coalesced);
+        objectCanvas->inputCoalescer.resetCounters();
+
+        auto* dragged = objectCanvas->objects[0];
+        auto [averageTime, longestTime] = simulateFastDrag(objectCanvas, dragged, dragged->getLocalBounds().getCentre().toFloat(), { 300.0f, 200.0f });
+        std::cout << "OBJECT GROUP DRAG " << mode << ": " << objectCanvas->inputCoalescer.getNumReceived() << " EVENTS, " << objectCanvas->inputCoalescer.getNumApplied() << " APPLIED, " << averageTime << " ms average, " << longestTime << " ms max" << std::endl;
+
+        objectCanvas->undo(); // Move the objects back for the next run
+        objectCanvas->performSynchronise();
+    }
+
+    sliderCanvas->inputCoalescer.setEnabled(InputCoalescer::enabledByDefault);
+    objectCanvas->inputCoalescer.setEnabled(InputCoalescer::enabledByDefault);
+
+    tabbar.closeTab(objectCanvas);
+    tabbar.closeTab(sliderCanvas);
+}
+
+// Drags an object across a canvas with 10000 objects and connections, most of which are out of view
+// Mouse events arrive every millisecond and frames are rendered on a 60 Hz vblank, like they would be in the app
+// The input latency is the time from a mouse event to the end of the frame that shows it, and a frame that overruns the vblank drops the next one
+// Runs once without load, and once with pd changing the state of every toggle in the patch each frame
+// Neither number should depend on the size of the patch, since only the objects and connections in view are rendered
+void benchmarkLargeCanvasUpdates(TabComponent& tabbar)
+{
+    constexpr int numColumns = 100;
+    constexpr int numObjects = 10000;
+
+    String patch = "#N canvas 0 0 1000 1000 12;\n";
+    for (int i = 0; i < numObjects; i++) {
+        patch += "#X obj " + String((i % numColumns) * 80) + " " + String((i / numColumns) * 50) + (i % 10 ? " + 1" : " tgl 15 0 empty large-canvas-load empty 17 7 0 10 #fcfcfc #000000 #000000 0 1") + ";\n";
+    }
+    for (int i = 0; i < numObjects - numColumns; i++) {
+        patch += "#X connect " + String(i) + " 0 " + String(i + numColumns) + " 0;\n";
+    }
+
+    auto* cnv = tabbar.openPatch(patch);
+    auto* pd = cnv->editor->pd;
+    auto& surface = cnv->editor->nvgSurface;
+    surface.render();
+
+    auto* target = cnv->objects.getFirst();
+    for (auto* object : cnv->objects) {
+        if (object->getType() == "tgl" && cnv->viewport->getViewArea().contains(object->getBounds().getCentre())) {
+            target = object;
+            break;
+        }
+    }
+
+    for (auto underLoad : { false, true }) {
+        constexpr double vblankInterval = 1000.0 / 60.0;
+        constexpr double eventInterval = 1.0;
+        constexpr double duration = 2000.0;
+
+        auto const start = target->getLocalBounds().getCentre().toFloat();
+        target->mouseDown(createFakeMouseEvent(target, start, start));
+
+        std::vector<double> pendingEvents;
+        double totalLatency = 0.0, maxLatency = 0.0;
+        int numEvents = 0, numFrames = 0, numDroppedFrames = 0;
+
+        auto const startTime = Time::getMillisecondCounterHiRes();
+        auto nextEvent = startTime;
+        auto nextVblank = startTime + vblankInterval;
+        while (nextVblank - startTime < duration) {
+            // Events that were due while the last frame rendered are late, which counts towards their latency
+            auto now = Time::getMillisecondCounterHiRes();
+            for (; nextEvent <= now && nextEvent < nextVblank; nextEvent += eventInterval) {
+                auto const progress = static_cast<float>((nextEvent - startTime) / duration);
+                target->mouseDrag(createFakeMouseEvent(target, start + Point<float>(200.0f, 100.0f) * progress, start));
+                pendingEvents.push_back(nextEvent);
+            }
+
+            if (now < nextVblank) {
+                Thread::yield();
+                continue;
+            }
+
+            if (underLoad) {
+                pd->lockAudioThread();
+                pd->sendFloat("large-canvas-load", numFrames % 2);
+                pd->unlockAudioThread();
+            }
+
+            cnv->inputCoalescer.flush(); // This is what the vblank callback would do
+            surface.render();
+            numFrames++;
+
+            auto const frameEnd = Time::getMillisecondCounterHiRes();
+            for (auto const eventTime : pendingEvents) {
+                totalLatency += frameEnd - eventTime;
+                maxLatency = std::max(maxLatency, frameEnd - eventTime);
+            }
+            numEvents += static_cast<int>(pendingEvents.size());
+            pendingEvents.clear();
+
+            // The next frame starts at the first vblank after this one finished
+            nextVblank += vblankInterval;
+            for (; nextVblank <= frameEnd; nextVblank += vblankInterval)
+                numDroppedFrames++;
+        }
+
+        target->mouseUp(createFakeMouseEvent(target, start + Point<float>(200.0f, 100.0f), start));
+        cnv->undo(); // Move the object back for the next run
+        cnv->performSynchronise();
+
+        auto const frameRate = numFrames * 1000.0 / (Time::getMillisecondCounterHiRes() - startTime);
+        std::cout << "DRAG ON " << cnv->objects.size() << " OBJECTS" << (underLoad ? " UNDER LOAD: " : ": ") << frameRate << " fps, " << numDroppedFrames << " dropped frames, " << totalLatency / std::max(numEvents, 1) << " ms average input latency, " << maxLatency << " ms max" << std::endl;
+    }
+
+    auto const numObjectsInView = cnv->getObjectsInView().size();
+    auto const numConnectionsInView = cnv->getConnectionsInView().size();
+    std::cout << "IN VIEW: " << numObjectsInView << " objects, " << numConnectionsInView << " connections" << std::endl;
+
+    // The viewport shows a few hundred objects at most, anything close to the whole patch means the culling doesn't work
+    expect(numObjectsInView > 0 && numObjectsInView < numObjects / 10, "only the objects in view are rendered");
+    expect(numConnectionsInView > 0 && numConnectionsInView < numObjects / 10, "only the connections in view are rendered");
+
+    tabbar.closeTab(cnv);
+}
+
+// Measures opening, scrolling and deleting from the automation panel with every parameter enabled
+void benchmarkAutomationPanel(PluginEditor* editor)
+{
+    Array<PlugDataParameter*> params;
+    for (auto* param : editor->pd->getParameters())
+        params.add(dynamic_cast<PlugDataParameter*>(param));
+
+    params.remove(0); // Skip the volume parameter
+
+    for (int i = 0; i < params.size(); i++) {
+        params[i]->setEnabled(true);
+        params[i]->setIndex(i);
+    }
+
+    auto startTime = Time::getMillisecondCounterHiRes();
+    auto panel = std::make_unique<AutomationPanel>(editor->pd);
+    editor->addAndMakeVisible(panel.get());
+    panel->setBounds(0, 0, 250, 600);
+    panel->handleAsyncUpdate();
+    auto openTime = Time::getMillisecondCounterHiRes() - startTime;
+
+    double totalTime = 0.0, maxTime = 0.0;
+    constexpr int numFrames = 240;
+    for (int frame = 0; frame < numFrames; frame++) {
+        startTime = Time::getMillisecondCounterHiRes();
+        panel->viewport.setViewPosition(0, frame * 60);
+        auto frameTime = Time::getMillisecondCounterHiRes() - startTime;
+
+        totalTime += frameTime;
+        maxTime = std::max(maxTime, frameTime);
+    }
+
+    std::cout << "AUTOMATION PANEL OPEN " << params.size() << " PARAMETERS: " << openTime << " ms, " << panel->sliders.items.size() << " items" << std::endl;
+    expect(panel->sliders.items.size() < params.size(), "automation panel only creates components for visible rows");
+    std::cout << "AUTOMATION PANEL SCROLL " << numFrames << " FRAMES: " << totalTime / numFrames << " ms average, " << maxTime << " ms max" << std::endl;
+
+    constexpr int numDeletions = 64;
+    startTime = Time::getMillisecondCounterHiRes();
+    for (int i = 0; i < numDeletions; i++) {
+        panel->sliders.deleteParameter(panel->sliders.rows[panel->sliders.rows.size() / 2]);
+    }
+    std::cout << "AUTOMATION PANEL DELETE " << numDeletions << " PARAMETERS: " << (Time::getMillisecondCounterHiRes() - startTime) / numDeletions << " ms per parameter" << std::endl;
+
+    panel.reset();
+
+    for (int i = 0; i < params.size(); i++) {
+        params[i]->setEnabled(false);
+        params[i]->setName("param" + String(i + 1));
+        params[i]->setIndex(i + 1);
+    }
+}
+
+// Enables every parameter with a distinct name, index, range and mode
+void setUpParameters(Array<AudioProcessorParameter*> const& parameters)
+{
+    for (int i = 1; i < parameters.size(); i++) {
+        auto* param = dynamic_cast<PlugDataParameter*>(parameters[i]);
+        param->setEnabled(true);
+        param->setName("automation" + String(i));
+        param->setIndex(i);
+        param->setRange(-static_cast<float>(i), static_cast<float>(i));
+        param->setMode(static_cast<PlugDataParameter::Mode>(1 + i % 4), false);
+    }
+}
+
+void resetParameters(Array<AudioProcessorParameter*> const& parameters)
+{
+    for (int i = 1; i < parameters.size(); i++) {
+        auto* param = dynamic_cast<PlugDataParameter*>(parameters[i]);
+        param->setEnabled(false);
+        param->setName("param" + String(i));
+        param->setRange(0.0f, 1.0f);
+        param->setMode(PlugDataParameter::Float, false);
+        param->setValue(param->getDefaultValue());
+    }
+}
+
+// Checks that every parameter survives a save and load of the parameter state
+void testParameterState(PluginEditor* editor)
+{
+    auto& parameters = editor->pd->getParameters();
+    setUpParameters(parameters);
+
+    MemoryOutputStream state;
+    PlugDataParameter::saveStateInformation(state, parameters);
+    resetParameters(parameters);
+
+    MemoryInputStream input(state.getData(), state.getDataSize(), false);
+    PlugDataParameter::loadStateInformation(input, parameters);
+
+    int numMismatches = 0;
+    for (int i = 1; i < parameters.size(); i++) {
+        auto* param = dynamic_cast<PlugDataParameter*>(parameters[i]);
+        if (param->getTitle() != "automation" + String(i) || param->getIndex() != i || param->getNormalisableRange().end != static_cast<float>(i) || !param->isEnabled())
+            numMismatches++;
+    }
+    expect(numMismatches == 0, "parameter state round trip (" + String(numMismatches) + " parameters changed)");
+
+    // Older versions only read the PARAM elements, so those need to hold the same state
+    setUpParameters(parameters);
+    XmlElement legacyState("plugdata_save");
+    PlugDataParameter::saveStateInformation(legacyState, parameters);
+    resetParameters(parameters);
+    PlugDataParameter::loadStateInformation(legacyState, parameters);
+
+    numMismatches = 0;
+    for (int i = 1; i < parameters.size(); i++) {
+        auto* param = dynamic_cast<PlugDataParameter*>(parameters[i]);
+        if (param->getTitle() != "automation" + String(i) || param->getIndex() != i || param->getNormalisableRange().end != static_cast<float>(i) || !param->isEnabled())
+            numMismatches++;
+    }
+    expect(numMismatches == 0, "legacy parameter state round trip (" + String(numMismatches) + " parameters changed)");
+
+    // Unused parameters are left out of the PARAM elements, and get their defaults back when loading
+    resetParameters(parameters);
+    dynamic_cast<PlugDataParameter*>(parameters[1])->setEnabled(true);
+    XmlElement sparseState("plugdata_save");
+    PlugDataParameter::saveStateInformation(sparseState, parameters);
+    expect(sparseState.getNumChildElements() == 2, "unused parameters are not written to the xml state");
+
+    setUpParameters(parameters);
+    PlugDataParameter::loadStateInformation(sparseState, parameters);
+
+    numMismatches = 0;
+    for (int i = 2; i < parameters.size(); i++) {
+        auto* param = dynamic_cast<PlugDataParameter*>(parameters[i]);
+        if (param->getTitle() != "param" + String(i) || param->getNormalisableRange().end != 1.0f || param->isEnabled())
+            numMismatches++;
+    }
+    expect(numMismatches == 0 && dynamic_cast<PlugDataParameter*>(parameters[1])->isEnabled(), "sparse parameter state round trip (" + String(numMismatches) + " parameters changed)");
+
+    resetParameters(parameters);
+}
+
+// Measures saving and loading the parameter state with every parameter enabled, and saving the whole session
+void benchmarkParameterState(PluginEditor* editor)
+{
+    auto& parameters = editor->pd->getParameters();
+    setUpParameters(parameters);
+
+    constexpr int numRoundTrips = 100;
+    MemoryOutputStream state;
+    double saveTime = 0.0, loadTime = 0.0;
+    for (int i = 0; i < numRoundTrips; i++) {
+        state.reset();
+
+        auto startTime = Time::getMillisecondCounterHiRes();
+        PlugDataParameter::saveStateInformation(state, parameters);
+        saveTime += Time::getMillisecondCounterHiRes() - startTime;
+
+        MemoryInputStream input(state.getData(), state.getDataSize(), false);
+        startTime = Time::getMillisecondCounterHiRes();
+        PlugDataParameter::loadStateInformation(input, parameters);
+        loadTime += Time::getMillisecondCounterHiRes() - startTime;
+    }
+
+    std::cout << "PARAMETER STATE " << parameters.size() - 1 << " PARAMETERS: " << state.getDataSize() << " bytes, " << saveTime / numRoundTrips << " ms save, " << loadTime / numRoundTrips << " ms load" << std::endl;
+
+    // The host saves the whole session, which holds the parameters twice: as PARAM elements and as the binary chunk
+    auto measureSessionSave = [editor](char const* label) {
+        constexpr int numSaves = 100;
+        MemoryBlock session;
+        double sessionSaveTime = 0.0;
+        for (int i = 0; i < numSaves; i++) {
+            session.reset();
+            auto const startTime = Time::getMillisecondCounterHiRes();
+            editor->pd->getStateInformation(session);
+            sessionSaveTime += Time::getMillisecondCounterHiRes() - startTime;
+        }
+        std::cout << "SESSION SAVE " << label << ": " << session.getSize() << " bytes, " << sessionSaveTime / numSaves << " ms" << std::endl;
+    };
+
+    measureSessionSave("ALL PARAMETERS USED");
+    resetParameters(parameters);
+    measureSessionSave("NO PARAMETERS USED");
+}
+
+// Several threads create, copy and free objects at the same time, with the allocator reusing addresses between them
+// Checks that a reference is valid until its object is freed, and never after
+void testWeakReferences()
+{
+    pd::WeakReferenceRegistry registry;
+
+    constexpr int numThreads = 8;
+    constexpr int numIterations = 200000;
+    std::atomic<int> numErrors = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&registry, &numErrors, t]() {
+            Random random(t);
+            std::vector<std::pair<int*, pd::WeakReferenceRegistry::Handle>> alive;
+
+            for (int i = 0; i < numIterations; i++) {
+                if (alive.size() < 64 && random.nextBool()) {
+                    auto* object = new int(i);
+                    alive.emplace_back(object, registry.getHandle(object));
+                } else if (!alive.empty()) {
+                    auto const index = random.nextInt(static_cast<int>(alive.size()));
+                    auto [object, handle] = alive[index];
+
+                    auto const copy = handle;
+                    auto const again = registry.getHandle(object);
+                    if (!copy.isValid() || !again.isValid() || again.slot != handle.slot)
+                        numErrors++;
+
+                    registry.invalidate(object);
+                    if (handle.isValid() || copy.isValid() || again.isValid())
+                        numErrors++;
+
+                    delete object;
+                    alive.erase(alive.begin() + index);
+                }
+            }
+
+            for (auto& [object, handle] : alive) {
+                registry.invalidate(object);
+                delete object;
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    expect(numErrors == 0, "weak references are valid until their object is freed, and never after (" + String(numErrors.load()) + " errors)");
+    expect(registry.getNumSlots() == 0, "freeing every object releases its slot (" + String(registry.getNumSlots()) + " slots left)");
+
+    // Objects at addresses that are never reused: without slot reuse, every one of them would need a new slot
+    pd::WeakReferenceRegistry distinctRegistry;
+    constexpr int numDistinctObjects = 1000000;
+    constexpr int numLiveObjects = 256;
+    std::vector<int> distinctObjects(numDistinctObjects);
+    int numInvalid = 0;
+    for (int i = 0; i < numDistinctObjects; i++) {
+        if (!distinctRegistry.getHandle(&distinctObjects[i]).isValid())
+            numInvalid++;
+
+        if (i >= numLiveObjects)
+            distinctRegistry.invalidate(&distinctObjects[i - numLiveObjects]);
+    }
+    for (int i = numDistinctObjects - numLiveObjects; i < numDistinctObjects; i++) {
+        distinctRegistry.invalidate(&distinctObjects[i]);
+    }
+
+    expect(numInvalid == 0, "weak references to new objects are valid");
+    expect(distinctRegistry.getNumSlots() == 0, "slots of freed objects are reused (" + String(distinctRegistry.getNumSlots()) + " slots left)");
+    expect(distinctRegistry.getNumTables() == 1, "the registry doesn't grow when objects are freed (" + String(distinctRegistry.getNumTables()) + " tables)");
+}
+
+// Object churn: most objects are freed without ever being referenced, the rest get referenced and copied a few times
+void benchmarkWeakReferences()
+{
+    pd::WeakReferenceRegistry registry;
+
+    constexpr int numObjects = 1000000;
+    std::vector<std::unique_ptr<int>> objects;
+    objects.reserve(1024);
+
+    int numInvalid = 0;
+    auto const startTime = Time::getMillisecondCounterHiRes();
+    for (int i = 0; i < numObjects; i++) {
+        auto& object = objects.emplace_back(std::make_unique<int>(i));
+        if ((i % 4) == 0) {
+            auto handle = registry.getHandle(object.get());
+            for (int copy = 0; copy < 4; copy++) {
+                auto const copiedHandle = handle;
+                if (!copiedHandle.isValid())
+                    numInvalid++;
+            }
+        }
+
+        if (objects.size() == 1024 || i == numObjects - 1) {
+            for (auto& toFree : objects) {
+                registry.invalidate(toFree.get());
+            }
+            objects.clear();
+        }
+    }
+    auto const churnTime = Time::getMillisecondCounterHiRes() - startTime;
+
+    std::cout << "WEAK REFERENCE CHURN " << numObjects << " OBJECTS: " << churnTime << " ms, " << registry.getNumTables() << " tables, " << registry.getMemoryUsage() << " bytes" << std::endl;
+    expect(numInvalid == 0, "weak references are valid before their object is freed");
+    expect(registry.getNumSlots() == 0, "object churn leaves no slots behind (" + String(registry.getNumSlots()) + " slots left)");
+
+    // At most 256 objects are referenced at the same time, which fits in the first table
+    expect(registry.getNumTables() == 1, "object churn doesn't grow the registry (" + String(registry.getNumTables()) + " tables)");
+}
+
+// Holds the pd lock on the message thread for longer and longer, while another thread processes audio like a host would
+// Checks that the audio lock guard keeps processBlock from waiting for the GUI, and compares the longest block with and without the guard
+void testAudioLockContention()
+{
+    auto processor = std::make_unique<PluginProcessor>();
+    constexpr int blockSize = 256;
+    processor->prepareToPlay(44100.0, blockSize);
+
+    auto const measureContention = [&processor](bool const useLockGuard) {
+        processor->setAudioLockGuard(useLockGuard);
+        processor->numMissedBlocks = 0;
+        processor->lockTelemetry.reset();
+
+        std::atomic<bool> isRunning = true;
+        std::atomic<double> longestBlock = 0.0;
+        std::thread audioThread([&processor, &isRunning, &longestBlock]() {
+            AudioBuffer<float> buffer(2, blockSize);
+            MidiBuffer midi;
+            while (isRunning) {
+                buffer.clear();
+                auto const start = Time::getMillisecondCounterHiRes();
+                processor->processBlock(buffer, midi);
+                longestBlock = std::max(longestBlock.load(), Time::getMillisecondCounterHiRes() - start);
+                Thread::sleep(5);
+            }
+        });
+
+        // Long GUI operations, like pasting or opening a large patch
+        for (int holdTime = 1; holdTime <= 64; holdTime *= 2) {
+            processor->lockAudioThread();
+            Thread::sleep(holdTime);
+            processor->unlockAudioThread();
+            Thread::sleep(20);
+        }
+
+        isRunning = false;
+        audioThread.join();
+
+        std::cout << "AUDIO LOCK CONTENTION (" << (useLockGuard ? "guarded" : "blocking") << "): " << longestBlock.load() << " ms longest block, " << processor->numMissedBlocks.load() << " missed blocks" << std::endl;
+        return longestBlock.load();
+    };
+
+    measureContention(false);
+    auto const longestGuardedBlock = measureContention(true);
+
+    // The longest hold is 64 ms, a guarded block should give up long before that
+    expect(longestGuardedBlock < 32.0, "audio lock guard doesn't wait for the GUI to release the lock");
+    expect(processor->numMissedBlocks > 0, "audio lock guard counts the blocks it missed");
+    expect(!processor->lockTelemetry.getLongestHolds(1).empty(), "lock telemetry records the call sites that held the lock");
+
+    processor->setAudioLockGuard(false);
+}
+
+// An object that counts the initbang messages it gets, pd sends those to patches that are opened from a file
+static int numInitBangs = 0;
+static t_class* initBangCounterClass = nullptr;
+
+// Restores a patch with an initbang receiver and an array the way a saved session is restored, through Instance::openPatch(PreparedPatch)
+// Checks that it gets its initbang like a patch opened from a file, that the array gets its values, and that #A isn't left bound to the array
+void testStateRestore(PluginEditor* editor)
+{
+    auto* pd = editor->pd;
+    pd->setThis();
+
+    if (!initBangCounterClass) {
+        initBangCounterClass = class_new(gensym("plugdata_initbang_counter"), reinterpret_cast<t_newmethod>(+[]() -> void* { return pd_new(initBangCounterClass); }), nullptr, sizeof(t_object), CLASS_NOINLET, A_NULL);
+        class_addmethod(initBangCounterClass, reinterpret_cast<t_method>(+[](t_object*, t_floatarg) { numInitBangs++; }), gensym("initbang"), A_DEFFLOAT, A_NULL);
+    }
+
+    String const content = "#N canvas 0 0 450 300 12;\n"
+                           "#X obj 10 10 plugdata_initbang_counter;\n"
+                           "#N canvas 0 0 450 300 (subpatch) 0;\n"
+                           "#X array plugdata-restore-array 4 float 2;\n"
+                           "#A 0 1 2 3 4;\n"
+                           "#X coords 0 5 4 0 200 140 1;\n"
+                           "#X restore 10 40 graph;\n";
+
+    auto prepared = pd->preparePatches({ { content, File(), false } });
+
+    pd->lockAudioThread();
+    auto* boundA = gensym("#A")->s_thing;
+    numInitBangs = 0;
+
+    auto patch = pd->openPatch(prepared.front());
+    expect(patch->getPointer().get() != nullptr, "restored patch opens");
+    expect(numInitBangs == 1, "restored patch gets its initbang");
+    expect(gensym("#A")->s_thing == boundA, "restoring a patch with an array leaves #A as it was");
+
+    auto* array = reinterpret_cast<t_garray*>(pd_findbyclass(gensym("plugdata-restore-array"), garray_class));
+    int size = 0;
+    t_word* values = nullptr;
+    if (expect(array && garray_getfloatwords(array, &size, &values) && size == 4, "restored array has its size")) {
+        expect(values[0].w_float == 1.0f && values[3].w_float == 4.0f, "restored array has its values");
+    }
+
+    patch = nullptr;
+    pd->unlockAudioThread();
+}
+
+// Checks that a .pdc cache gives back the same atoms, also for symbols that aren't valid UTF-8, and that it's rejected once the source changes
+void testPatchCache(PluginEditor* editor)
+{
+    std::string const text = "#X obj 10 10 r caf\xe9;\n#X msg 10 40 1 2 3;\n"; // A Latin-1 patch
+    MemoryBlock source(text.data(), text.size());
+    auto cacheFile = File::createTempFile("pdc");
+
+    editor->pd->setThis();
+    editor->pd->lockAudioThread();
+
+    auto* original = binbuf_new();
+    binbuf_text(original, text.data(), static_cast<int>(text.size()));
+    pd::PatchCache::writeCache(cacheFile, source, original);
+
+    pd::PatchCache::Content content;
+    if (expect(pd::PatchCache::readCache(cacheFile, source, content), "patch cache can be read back")) {
+        auto* restored = binbuf_new();
+        pd::PatchCache::addToBinbuf(content, restored);
+
+        auto const numAtoms = binbuf_getnatom(original);
+        auto isEqual = binbuf_getnatom(restored) == numAtoms;
+        for (int i = 0; isEqual && i < numAtoms; i++) {
+            auto const& a = binbuf_getvec(original)[i];
+            auto const& b = binbuf_getvec(restored)[i];
+            isEqual = a.a_type == b.a_type && (a.a_type != A_FLOAT || a.a_w.w_float == b.a_w.w_float) && (a.a_type != A_SYMBOL || a.a_w.w_symbol == b.a_w.w_symbol);
+        }
+        expect(isEqual, "patch cache restores the same atoms, including symbols that aren't UTF-8");
+
+        binbuf_free(restored);
+    }
+
+    binbuf_free(original);
+    editor->pd->unlockAudioThread();
+
+    auto changedText = text;
+    changedText[changedText.size() - 3] = '4';
+    expect(!pd::PatchCache::readCache(cacheFile, MemoryBlock(changedText.data(), changedText.size()), content), "patch cache is rejected when the source changed");
+
+    cacheFile.deleteFile();
+}
+
+// Checks that pushing onto a full message stack fails instead of allocating, and that swapping the buffers gives the stack more room afterwards
+void testMessageStackGrowth()
+{
+    ThreadSafeStack<int, 16> stack;
+    auto const fill = [&stack]() {
+        int numPushed = 0;
+        while (stack.push(numPushed) && numPushed < 100000)
+            numPushed++;
+        return numPushed;
+    };
+
+    auto const firstCapacity = fill();
+    expect(firstCapacity >= 16 && firstCapacity < 100000, "message stack stops taking messages when it's full");
+
+    // The full buffer makes the stack grow, which the producer sees two swaps later
+    int value;
+    stack.swapBuffers();
+    while (stack.pop(value)) { }
+    stack.swapBuffers();
+    expect(fill() > firstCapacity, "message stack grows after it was filled");
+}
+
+// Floods one ring per simulated MIDI device from its own thread, while another thread reads them like the audio thread would
+// Every event carries its sequence number, so we can check that nothing is reordered and that the driver timestamps come out unchanged
+void testMidiInputRings()
+{
+    constexpr int numDevices = 4;
+    constexpr int numEvents = 100000;
+
+    std::vector<std::unique_ptr<MidiInputRing>> rings;
+    for (int i = 0; i < numDevices; i++) {
+        rings.push_back(std::make_unique<MidiInputRing>());
+    }
+
+    auto const startTime = Time::getMillisecondCounterHiRes() * 0.001;
+    auto const getTimestamp = [startTime](int device, int sequence) {
+        return startTime + sequence * 0.0001 + device * 0.00001;
+    };
+
+    std::atomic<int> numProducersRunning = numDevices;
+    std::atomic<double> longestPush = 0.0;
+    std::vector<std::thread> devices;
+    for (int device = 0; device < numDevices; device++) {
+        devices.emplace_back([&rings, &numProducersRunning, &longestPush, &getTimestamp, device]() {
+            uint8 data[256] = {};
+            for (int sequence = 0; sequence < numEvents; sequence++) {
+                std::memcpy(data, &sequence, sizeof(int));
+                auto const size = sequence % 100 == 0 ? 256 : 3 + static_cast<int>(sizeof(int)); // Some sysex in between the controller changes
+
+                auto const start = Time::getMillisecondCounterHiRes();
+                rings[device]->push(data, size, getTimestamp(device, sequence));
+                longestPush = std::max(longestPush.load(), Time::getMillisecondCounterHiRes() - start);
+
+                if (sequence % 1000 == 0)
+                    std::this_thread::yield();
+            }
+            numProducersRunning--;
+        });
+    }
+
+    std::vector<int> lastSequence(numDevices, -1);
+    int numReceived = 0;
+    bool orderIsCorrect = true, timingIsCorrect = true;
+
+    auto const readRings = [&]() {
+        for (int device = 0; device < numDevices; device++) {
+            rings[device]->popAll([&](uint8 const* data, int size, double timestamp) {
+                int sequence;
+                std::memcpy(&sequence, data, sizeof(int));
+                orderIsCorrect = orderIsCorrect && sequence > lastSequence[device];
+                timingIsCorrect = timingIsCorrect && timestamp == getTimestamp(device, sequence) && size == (sequence % 100 == 0 ? 256 : 3 + static_cast<int>(sizeof(int)));
+                lastSequence[device] = sequence;
+                numReceived++;
+            });
+        }
+    };
+
+    while (numProducersRunning > 0) {
+        readRings();
+        Thread::sleep(1);
+    }
+    readRings();
+
+    for (auto& device : devices) {
+        device.join();
+    }
+
+    int numDropped = 0;
+    for (auto& ring : rings) {
+        numDropped += ring->getNumDropped();
+    }
+
+    expect(orderIsCorrect, "MIDI input rings keep the order of events");
+    expect(timingIsCorrect, "MIDI input rings keep event timestamps and sizes");
+    expect(numReceived + numDropped == numDevices * numEvents, "MIDI input rings account for every event");
+
+    std::cout << "MIDI INPUT RINGS " << numDevices << " DEVICES: " << numReceived << " events received, " << numDropped << " dropped, " << longestPush.load() * 1000.0 << " us longest push" << std::endl;
+}
+
+// The benchmarks only print timings and are slow, so they only run when building with ENABLE_BENCHMARKS
+void runBenchmarks(PluginEditor* editor)
+{
+    benchmarkWeakReferences();
+
+    benchmarkInstantiation(100);
+    editor->pd->setThis(); // Destroying the other instances changes the active pd instance
+
+    benchmarkPatchOpening(editor->getTabComponent());
+    benchmarkObjectFootprint(editor->getTabComponent());
+    benchmarkConnections(editor->getTabComponent());
+    benchmarkPanning(editor->getTabComponent());
+    benchmarkLargeCanvasUpdates(editor->getTabComponent());
+    benchmarkZooming(editor->getTabComponent());
+    benchmarkIdleFrames(editor, 20);
+    benchmarkDragging(editor->getTabComponent());
+    benchmarkAutomationPanel(editor);
+    benchmarkParameterState(editor);
+}
+
 void runTests(PluginEditor* editor)
 {
+    // Editors opened by the tests schedule a test run as well, only the first one runs them
+    static bool hasRun = false;
+    if (std::exchange(hasRun, true))
+        return;
+
+#if ENABLE_BENCHMARKS
+    runBenchmarks(editor);
+#endif
+
+    testWeakReferences();
+    testAudioLockContention();
+    editor->pd->setThis();
+    testMidiInputRings();
+    testMessageStackGrowth();
+    testPatchCache(editor);
+    testStateRestore(editor);
+
+    testAbstractionTooltips(editor->getTabComponent());
+    testConnectionIndex(editor->getTabComponent());
+    testSuspendAndResume(editor);
+    testInputCoalescing(editor->getTabComponent());
+    testParameterState(editor);
+
     static std::vector<File> allHelpfiles = {};
     // Open every helpfile, this will make sure it initialises and closes every object at least once (but probasbly a whole bunch of times in different contexts)
     // Run with AddressSanitizer, UBSanitizer or ThreadSanitizer to find all memory, UB and threading problems